@@ -0,0 +1,189 @@
+#pragma once
+
+namespace Soup::Test
+{
+	/// <summary>
+	/// The allocations made on a single thread, the live bytes go down when memory from another thread is freed here
+	/// </summary>
+	struct ThreadAllocations
+	{
+		size_t Count;
+		size_t Bytes;
+		int64_t LiveBytes;
+		int64_t PeakLiveBytes;
+	};
+
+	inline thread_local ThreadAllocations CurrentThreadAllocations = {};
+
+#ifndef SOUP_TEST_ENABLE_ALLOCATION_HOOKS
+	constexpr bool AllocationHooksEnabled = false;
+#else
+	constexpr bool AllocationHooksEnabled = true;
+
+	/// <summary>
+	/// Stored in front of every allocation so the unsized delete knows how much it frees
+	/// </summary>
+	struct AllocationHeader
+	{
+		void* Block;
+		size_t Size;
+	};
+
+	inline void* TrackedAllocate(size_t size, size_t alignment) noexcept
+	{
+		alignment = std::max(alignment, alignof(std::max_align_t));
+		auto padding = sizeof(AllocationHeader) + alignment - 1;
+		if (size > SIZE_MAX - padding)
+			return nullptr;
+
+		auto block = std::malloc(size + padding);
+		if (block == nullptr)
+			return nullptr;
+
+		auto address = (reinterpret_cast<uintptr_t>(block) + sizeof(AllocationHeader) + alignment - 1) &
+			~static_cast<uintptr_t>(alignment - 1);
+		auto header = reinterpret_cast<AllocationHeader*>(address) - 1;
+		header->Block = block;
+		header->Size = size;
+
+		auto& allocations = CurrentThreadAllocations;
+		allocations.Count++;
+		allocations.Bytes += size;
+		allocations.LiveBytes += static_cast<int64_t>(size);
+		allocations.PeakLiveBytes = std::max(allocations.PeakLiveBytes, allocations.LiveBytes);
+
+		return reinterpret_cast<void*>(address);
+	}
+
+	inline void* TrackedAllocateOrThrow(size_t size, size_t alignment)
+	{
+		// Follow the standard allocation loop, the new handler may free memory and try again
+		while (true)
+		{
+			auto memory = TrackedAllocate(size == 0 ? 1 : size, alignment);
+			if (memory != nullptr)
+				return memory;
+
+			auto handler = std::get_new_handler();
+			if (handler == nullptr)
+				throw std::bad_alloc();
+
+			handler();
+		}
+	}
+
+	inline void TrackedDeallocate(void* memory) noexcept
+	{
+		if (memory == nullptr)
+			return;
+
+		auto header = static_cast<AllocationHeader*>(memory) - 1;
+		CurrentThreadAllocations.LiveBytes -= static_cast<int64_t>(header->Size);
+		std::free(header->Block);
+	}
+#endif
+}
+
+// Replacing the global allocation functions changes them for the whole program, including the code under test,
+// so the hooks are only compiled in when the runtime is built with SOUP_TEST_ENABLE_ALLOCATION_HOOKS
+#ifdef SOUP_TEST_ENABLE_ALLOCATION_HOOKS
+void* operator new(std::size_t size)
+{
+	return Soup::Test::TrackedAllocateOrThrow(size, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t size)
+{
+	return Soup::Test::TrackedAllocateOrThrow(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	return Soup::Test::TrackedAllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+	return Soup::Test::TrackedAllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	return Soup::Test::TrackedAllocate(size == 0 ? 1 : size, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+	return Soup::Test::TrackedAllocate(size == 0 ? 1 : size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return Soup::Test::TrackedAllocate(size == 0 ? 1 : size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return Soup::Test::TrackedAllocate(size == 0 ? 1 : size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* memory) noexcept
+{
+	Soup::Test::TrackedDeallocate(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	Soup::Test::TrackedDeallocate(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+	Soup::Test::TrackedDeallocate(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+	Soup::Test::TrackedDeallocate(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept
+{
+	Soup::Test::TrackedDeallocate(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t) noexcept
+{
+	Soup::Test::TrackedDeallocate(memory);
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept
+{
+	Soup::Test::TrackedDeallocate(memory);
+}
+
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept
+{
+	Soup::Test::TrackedDeallocate(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+	Soup::Test::TrackedDeallocate(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+	Soup::Test::TrackedDeallocate(memory);
+}
+
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	Soup::Test::TrackedDeallocate(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	Soup::Test::TrackedDeallocate(memory);
+}
+#endif
@@ -0,0 +1,111 @@
+#pragma once
+
+namespace Soup::Test
+{
+	/// <summary>
+	/// The allocations made on one thread over a span of code
+	/// </summary>
+	export struct AllocationStats
+	{
+		size_t Count;
+		size_t Bytes;
+
+		// The most bytes allocated within the span and alive at the same time
+		size_t PeakLiveBytes;
+	};
+
+	/// <summary>
+	/// Allocation tracking replaces the global operator new and delete, only when the runtime is built with SOUP_TEST_ENABLE_ALLOCATION_HOOKS
+	/// </summary>
+	export constexpr bool IsAllocationTrackingEnabled()
+	{
+		return AllocationHooksEnabled;
+	}
+
+	/// <summary>
+	/// Counts the allocations of the current thread from construction, allocations made on other threads are not seen.
+	/// Scopes may nest, an inner scope restores the peak of the outer scope when it ends.
+	/// </summary>
+	export class AllocationScope
+	{
+	public:
+		AllocationScope() :
+			m_start(CurrentThreadAllocations)
+		{
+			CurrentThreadAllocations.PeakLiveBytes = m_start.LiveBytes;
+		}
+
+		AllocationScope(const AllocationScope&) = delete;
+		AllocationScope& operator=(const AllocationScope&) = delete;
+
+		~AllocationScope()
+		{
+			auto& allocations = CurrentThreadAllocations;
+			allocations.PeakLiveBytes = std::max(allocations.PeakLiveBytes, m_start.PeakLiveBytes);
+		}
+
+		AllocationStats GetStats() const
+		{
+			auto& allocations = CurrentThreadAllocations;
+			return AllocationStats{
+				allocations.Count - m_start.Count,
+				allocations.Bytes - m_start.Bytes,
+				static_cast<size_t>(std::max<int64_t>(allocations.PeakLiveBytes - m_start.LiveBytes, 0)),
+			};
+		}
+
+	private:
+		ThreadAllocations m_start;
+	};
+
+	/// <summary>
+	/// Lower the resident set high-water mark of the whole process to its current resident set,
+	/// so the next read only covers what ran since. Ignored where the platform cannot reset it.
+	/// </summary>
+	export void ResetPeakResidentBytes()
+	{
+#ifdef __linux__
+		auto file = open("/proc/self/clear_refs", O_WRONLY | O_CLOEXEC);
+		if (file < 0)
+			return;
+
+		// 5 resets the peak resident set size of the process
+		auto ignored = write(file, "5", 1);
+		(void)ignored;
+		close(file);
+#endif
+	}
+
+	/// <summary>
+	/// The resident set high-water mark of the whole process, zero where the platform does not report it
+	/// </summary>
+	export size_t GetPeakResidentBytes()
+	{
+#ifdef __linux__
+		// Opened every time since a forked process must not read the status of its parent
+		auto file = open("/proc/self/status", O_RDONLY | O_CLOEXEC);
+		if (file < 0)
+			return 0;
+
+		char buffer[4096];
+		auto readCount = read(file, buffer, sizeof(buffer) - 1);
+		close(file);
+		if (readCount <= 0)
+			return 0;
+
+		// VmHWM:	[SIZE] kB
+		auto status = std::string_view(buffer, static_cast<size_t>(readCount));
+		auto offset = status.find("VmHWM:");
+		if (offset == std::string_view::npos)
+			return 0;
+
+		auto value = status.substr(offset + 6);
+		value.remove_prefix(std::min(value.find_first_not_of(" \t"), value.size()));
+		size_t kilobytes = 0;
+		std::from_chars(value.data(), value.data() + value.size(), kilobytes);
+		return kilobytes * 1024;
+#else
+		return 0;
+#endif
+	}
+}
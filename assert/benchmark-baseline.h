@@ -0,0 +1,246 @@
+#pragma once
+
+namespace Soup::Test
+{
+	/// <summary>
+	/// A benchmark measured against its saved baseline
+	/// </summary>
+	export struct BenchmarkComparison
+	{
+		const BenchmarkResult* Result;
+		bool HasBaseline;
+		double BaselineMedian;
+
+		// The relative change of the median, positive is slower
+		double Change;
+
+		// The one sided Mann-Whitney probability of samples at least this much slower if nothing changed
+		double PValue;
+		bool IsRegression;
+	};
+
+	/// <summary>
+	/// The saved repetition samples of every benchmark, used to gate later runs on performance regressions.
+	/// A regression must both be statistically significant over the repetition samples and move the median past the threshold,
+	/// so noise on a stable benchmark and a real but negligible change are both let through.
+	/// </summary>
+	export class BenchmarkBaseline
+	{
+	public:
+		static constexpr double Significance = 0.05;
+
+		static BenchmarkBaseline Load(const std::string& file)
+		{
+			auto inputFile = std::ifstream(file, std::ios::binary);
+			if (!inputFile)
+				throw std::runtime_error("Failed to read benchmark baseline: " + file);
+
+			// SoupTestBenchmarkBaseline [VERSION]
+			auto header = std::string();
+			auto version = 0;
+			if (!(inputFile >> header >> version) || header != "SoupTestBenchmarkBaseline" || version != FileVersion)
+				throw std::runtime_error("Unsupported benchmark baseline: " + file);
+
+			// Benchmark [NAME] [SAMPLE_COUNT] [SAMPLES]...
+			auto result = BenchmarkBaseline();
+			auto type = std::string();
+			while (inputFile >> type)
+			{
+				auto name = std::string();
+				size_t sampleCount = 0;
+				if (type != "Benchmark" || !(inputFile >> name >> sampleCount))
+					throw std::runtime_error("Invalid benchmark baseline: " + file);
+
+				auto samples = std::vector<double>();
+				samples.reserve(sampleCount);
+				auto value = std::string();
+				for (size_t i = 0; i < sampleCount; i++)
+				{
+					double sample = 0;
+					if (!(inputFile >> value) || !TryParseDouble(value, sample))
+						throw std::runtime_error("Invalid benchmark baseline: " + file);
+
+					samples.push_back(sample);
+				}
+
+				result.m_samples.insert_or_assign(std::move(name), std::move(samples));
+			}
+
+			return result;
+		}
+
+		static void Save(const std::string& file, const std::vector<BenchmarkResult>& results)
+		{
+			auto content = std::string();
+			content += "SoupTestBenchmarkBaseline " + std::to_string(FileVersion) + "\n";
+			for (auto& result : results)
+			{
+				content += "Benchmark ";
+				content += GetName(result);
+				content += " " + std::to_string(result.Samples.size());
+				for (auto sample : result.Samples)
+				{
+					// The shortest text that reads back as the same value
+					char buffer[32];
+					auto writeResult = std::to_chars(buffer, buffer + sizeof(buffer), sample);
+					content += " ";
+					content.append(buffer, writeResult.ptr);
+				}
+
+				content += "\n";
+			}
+
+			auto outputFile = std::ofstream(file, std::ios::binary);
+			outputFile.write(content.data(), content.size());
+			if (!outputFile)
+				throw std::runtime_error("Failed to write benchmark baseline: " + file);
+		}
+
+		/// <summary>
+		/// Compare each result with its baseline, the threshold is the relative slowdown of the median that fails
+		/// </summary>
+		std::vector<BenchmarkComparison> Compare(const std::vector<BenchmarkResult>& results, double threshold) const
+		{
+			auto comparisons = std::vector<BenchmarkComparison>();
+			for (auto& result : results)
+			{
+				auto comparison = BenchmarkComparison{ &result, false, 0, 0, 1, false };
+				auto baseline = m_samples.find(GetName(result));
+				if (baseline != m_samples.end() && !baseline->second.empty() && !result.Samples.empty())
+				{
+					comparison.HasBaseline = true;
+					comparison.BaselineMedian = GetMedian(baseline->second);
+					comparison.Change = comparison.BaselineMedian > 0 ?
+						result.Median / comparison.BaselineMedian - 1.0 :
+						0.0;
+					comparison.PValue = GetSlowerProbability(baseline->second, result.Samples);
+					comparison.IsRegression = comparison.PValue < Significance && comparison.Change > threshold;
+				}
+
+				comparisons.push_back(comparison);
+			}
+
+			return comparisons;
+		}
+
+		static std::string GetRegressionMessage(const BenchmarkComparison& comparison)
+		{
+			auto message = std::stringstream();
+			message << std::fixed << std::setprecision(3);
+			message << "Benchmark regressed: median " << comparison.BaselineMedian;
+			message << " -> " << comparison.Result->Median << " ns/op";
+			WriteChange(comparison, message);
+			return message.str();
+		}
+
+		static void WriteComparisons(const std::vector<BenchmarkComparison>& comparisons, std::ostream& output)
+		{
+			if (comparisons.empty())
+				return;
+
+			auto content = std::stringstream();
+			content << std::fixed << std::setprecision(3);
+			content << "Compared to baseline (median ns/op):\n";
+			for (auto& comparison : comparisons)
+			{
+				content << "\t" << GetName(*comparison.Result) << ": ";
+				if (comparison.HasBaseline)
+				{
+					content << comparison.BaselineMedian << " -> " << comparison.Result->Median;
+					WriteChange(comparison, content);
+					if (comparison.IsRegression)
+						content << " REGRESSION";
+				}
+				else
+				{
+					content << "new";
+				}
+
+				content << "\n";
+			}
+
+			output << content.str();
+		}
+
+	private:
+		static constexpr int FileVersion = 1;
+
+		static std::string GetName(const BenchmarkResult& result)
+		{
+			return std::string(result.Class->Name) + "::" + std::string(result.Test->Name);
+		}
+
+		static void WriteChange(const BenchmarkComparison& comparison, std::ostream& output)
+		{
+			// (+[CHANGE]%, p=[P_VALUE])
+			auto percentage = comparison.Change * 100.0;
+			output << std::setprecision(1) << " (" << (percentage >= 0 ? "+" : "") << percentage << "%";
+			output << std::setprecision(4) << ", p=" << comparison.PValue << ")" << std::setprecision(3);
+		}
+
+		static bool TryParseDouble(std::string_view value, double& result)
+		{
+			auto parseResult = std::from_chars(value.data(), value.data() + value.size(), result);
+			return parseResult.ec == std::errc() && parseResult.ptr == value.data() + value.size();
+		}
+
+		static double GetMedian(std::vector<double> samples)
+		{
+			std::sort(samples.begin(), samples.end());
+			auto count = samples.size();
+			return count % 2 == 1 ?
+				samples[count / 2] :
+				(samples[count / 2 - 1] + samples[count / 2]) / 2.0;
+		}
+
+		/// <summary>
+		/// The one sided Mann-Whitney U test that the current samples are larger than the baseline samples,
+		/// using the normal approximation with the tie and continuity corrections
+		/// </summary>
+		static double GetSlowerProbability(const std::vector<double>& baseline, const std::vector<double>& current)
+		{
+			// Rank the combined samples, every run of ties shares the mean of its ranks
+			auto samples = std::vector<std::pair<double, bool>>();
+			for (auto sample : baseline)
+				samples.emplace_back(sample, false);
+			for (auto sample : current)
+				samples.emplace_back(sample, true);
+			std::sort(samples.begin(), samples.end());
+
+			auto count = static_cast<double>(samples.size());
+			auto currentRankSum = 0.0;
+			auto tieSum = 0.0;
+			size_t tieStart = 0;
+			while (tieStart < samples.size())
+			{
+				auto tieEnd = tieStart + 1;
+				while (tieEnd < samples.size() && samples[tieEnd].first == samples[tieStart].first)
+					tieEnd++;
+
+				auto rank = static_cast<double>(tieStart + 1 + tieEnd) / 2.0;
+				for (auto i = tieStart; i < tieEnd; i++)
+				{
+					if (samples[i].second)
+						currentRankSum += rank;
+				}
+
+				auto tieCount = static_cast<double>(tieEnd - tieStart);
+				tieSum += tieCount * tieCount * tieCount - tieCount;
+				tieStart = tieEnd;
+			}
+
+			auto baselineCount = static_cast<double>(baseline.size());
+			auto currentCount = static_cast<double>(current.size());
+			auto u = currentRankSum - currentCount * (currentCount + 1) / 2.0;
+			auto mean = baselineCount * currentCount / 2.0;
+			auto variance = baselineCount * currentCount / 12.0 * ((count + 1) - tieSum / (count * (count - 1)));
+			if (variance <= 0)
+				return 1.0;
+
+			auto z = (u - mean - 0.5) / std::sqrt(variance);
+			return 0.5 * std::erfc(z / std::sqrt(2.0));
+		}
+
+		std::unordered_map<std::string, std::vector<double>> m_samples;
+	};
+}
@@ -0,0 +1,254 @@
+#pragma once
+
+namespace Soup::Test
+{
+	/// <summary>
+	/// The measurement settings shared by every benchmark in a run
+	/// </summary>
+	export struct BenchmarkOptions
+	{
+		// The target duration of a single repetition, the iteration count is calibrated to reach it
+		std::chrono::nanoseconds RepetitionTime = std::chrono::milliseconds(20);
+		size_t RepetitionCount = 10;
+
+		// The time spent running calibrated batches that are thrown away before the first repetition
+		std::chrono::nanoseconds WarmupTime = std::chrono::milliseconds(20);
+	};
+
+	/// <summary>
+	/// The measured cost of a single benchmark, every sample is the nanoseconds per iteration of one repetition
+	/// </summary>
+	export struct BenchmarkResult
+	{
+		size_t TableIndex;
+		const TestClassDescriptor* Class;
+		const TestDescriptor* Test;
+		size_t Iterations;
+		std::vector<double> Samples;
+		double Mean;
+		double Median;
+		double StdDev;
+		double P99;
+	};
+
+	/// <summary>
+	/// Runs the registered benchmarks one at a time on the calling thread so they never compete for the machine.
+	/// Each benchmark calibrates an iteration count that fills a repetition, warms up at that count
+	/// and then measures a fixed number of repetitions.
+	/// </summary>
+	export class BenchmarkRunner
+	{
+	public:
+		BenchmarkRunner(BenchmarkOptions options, TestFilter filter) :
+			m_options(options),
+			m_filter(std::move(filter))
+		{
+		}
+
+		/// <summary>
+		/// Write the full name of every selected benchmark without creating any test class
+		/// </summary>
+		void List(const std::vector<TestTable>& tables, std::ostream& output) const
+		{
+			for (auto& table : tables)
+			{
+				for (auto& test : table.Tests)
+				{
+					auto& testClass = table.Classes[test.ClassIndex];
+					if (IsSelected(testClass, test))
+						output << testClass.Name << "::" << test.Name << "\n";
+				}
+			}
+		}
+
+		/// <summary>
+		/// Measure every selected benchmark, a benchmark that throws is reported as a failed test
+		/// </summary>
+		TestState Run(
+			const std::vector<TestTable>& tables,
+			std::vector<TestResult>& results,
+			std::vector<BenchmarkResult>& benchmarkResults) const
+		{
+			// Hold the collection fixtures of every class up front so a fixture shared by several classes is only created once
+			auto isClassSelected = std::vector<std::vector<bool>>();
+			for (auto& table : tables)
+			{
+				auto& isSelected = isClassSelected.emplace_back(table.Classes.size(), false);
+				for (auto& test : table.Tests)
+				{
+					if (IsSelected(table.Classes[test.ClassIndex], test))
+						isSelected[test.ClassIndex] = true;
+				}
+
+				for (size_t classIndex = 0; classIndex < table.Classes.size(); classIndex++)
+				{
+					if (isSelected[classIndex])
+						RetainCollectionFixtures(table.Classes[classIndex]);
+				}
+			}
+
+			auto state = TestState{ 0, 0 };
+			for (size_t tableIndex = 0; tableIndex < tables.size(); tableIndex++)
+			{
+				auto& table = tables[tableIndex];
+				for (size_t classIndex = 0; classIndex < table.Classes.size(); classIndex++)
+				{
+					// The class is only created once one of its benchmarks is selected
+					auto& testClass = table.Classes[classIndex];
+					if (!isClassSelected[tableIndex][classIndex])
+						continue;
+
+					void* instance = nullptr;
+					for (auto& test : table.Tests)
+					{
+						if (test.ClassIndex != classIndex || !IsSelected(testClass, test))
+							continue;
+
+						auto benchmarkResult = BenchmarkResult{ tableIndex, &testClass, &test, 0, {}, 0, 0, 0, 0 };
+						auto runBenchmark = [this, &testClass, &test, &instance, &benchmarkResult]()
+						{
+							if (instance == nullptr)
+								instance = testClass.Create();
+
+							Measure(test, instance, benchmarkResult);
+						};
+
+						auto failureMessage = std::string();
+						auto startTime = std::chrono::steady_clock::now();
+						auto isPass = TryRunTestCase(runBenchmark, failureMessage);
+						auto duration = std::chrono::steady_clock::now() - startTime;
+
+						if (isPass)
+						{
+							benchmarkResults.push_back(std::move(benchmarkResult));
+							state.PassCount++;
+						}
+						else
+						{
+							ReportFailure(testClass.Name, test.Name, failureMessage);
+							state.FailCount++;
+						}
+
+						results.push_back(TestResult{
+							tableIndex,
+							&testClass,
+							&test,
+							0,
+							isPass,
+							std::chrono::duration_cast<std::chrono::nanoseconds>(duration),
+							AllocationStats{ 0, 0, 0 },
+							0,
+							std::move(failureMessage),
+						});
+					}
+
+					if (instance != nullptr)
+						testClass.Destroy(instance);
+
+					ReleaseCollectionFixtures(testClass);
+				}
+			}
+
+			return state;
+		}
+
+		static void WriteResults(const std::vector<BenchmarkResult>& results, std::ostream& output)
+		{
+			if (results.empty())
+				return;
+
+			auto content = std::stringstream();
+			content << std::fixed << std::setprecision(3);
+			content << "Benchmarks (ns/op):\n";
+			for (auto& result : results)
+			{
+				content << "\t" << result.Class->Name << "::" << result.Test->Name << ":";
+				content << " mean " << result.Mean;
+				content << " median " << result.Median;
+				content << " stddev " << result.StdDev;
+				content << " p99 " << result.P99;
+				content << " (" << result.Samples.size() << " x " << result.Iterations << " iterations)\n";
+			}
+
+			output << content.str();
+		}
+
+	private:
+		static constexpr size_t MaxIterations = 1000000000;
+
+		bool IsSelected(const TestClassDescriptor& testClass, const TestDescriptor& test) const
+		{
+			return test.IsBenchmark && m_filter.IsMatch(testClass.Name, test.Name, nullptr);
+		}
+
+		void Measure(const TestDescriptor& test, void* instance, BenchmarkResult& result) const
+		{
+			// Grow the iteration count until a batch fills a repetition, aiming a little past the target
+			// from the measured rate and growing at most tenfold while the timing is still mostly noise
+			size_t iterations = 1;
+			while (true)
+			{
+				auto elapsed = TimeIterations(test, instance, iterations);
+				if (elapsed >= m_options.RepetitionTime || iterations >= MaxIterations)
+					break;
+
+				auto targetScale = 1.2 * static_cast<double>(m_options.RepetitionTime.count()) /
+					static_cast<double>(std::max<std::chrono::nanoseconds::rep>(elapsed.count(), 1));
+				auto scaledIterations = static_cast<double>(iterations) * std::min(targetScale, 10.0);
+				iterations = std::clamp(static_cast<size_t>(scaledIterations), iterations + 1, MaxIterations);
+			}
+
+			auto warmupElapsed = std::chrono::nanoseconds(0);
+			while (warmupElapsed < m_options.WarmupTime)
+				warmupElapsed += TimeIterations(test, instance, iterations);
+
+			result.Iterations = iterations;
+			result.Samples.reserve(m_options.RepetitionCount);
+			for (size_t repetition = 0; repetition < m_options.RepetitionCount; repetition++)
+			{
+				auto elapsed = TimeIterations(test, instance, iterations);
+				result.Samples.push_back(static_cast<double>(elapsed.count()) / static_cast<double>(iterations));
+			}
+
+			Summarize(result);
+		}
+
+		static std::chrono::nanoseconds TimeIterations(const TestDescriptor& test, void* instance, size_t iterations)
+		{
+			auto startTime = std::chrono::steady_clock::now();
+			test.Invoke(instance, iterations);
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime);
+		}
+
+		static void Summarize(BenchmarkResult& result)
+		{
+			auto sorted = result.Samples;
+			std::sort(sorted.begin(), sorted.end());
+			if (sorted.empty())
+				return;
+
+			auto count = sorted.size();
+			auto sum = 0.0;
+			for (auto sample : sorted)
+				sum += sample;
+			result.Mean = sum / static_cast<double>(count);
+
+			result.Median = count % 2 == 1 ?
+				sorted[count / 2] :
+				(sorted[count / 2 - 1] + sorted[count / 2]) / 2.0;
+
+			// Sample standard deviation, a single repetition has no spread
+			auto squaredDeviations = 0.0;
+			for (auto sample : sorted)
+				squaredDeviations += (sample - result.Mean) * (sample - result.Mean);
+			result.StdDev = count > 1 ? std::sqrt(squaredDeviations / static_cast<double>(count - 1)) : 0.0;
+
+			// Nearest rank
+			auto rank = static_cast<size_t>(std::ceil(0.99 * static_cast<double>(count)));
+			result.P99 = sorted[std::max<size_t>(rank, 1) - 1];
+		}
+
+		BenchmarkOptions m_options;
+		TestFilter m_filter;
+	};
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+namespace Soup::Test
+{
+	/// <summary>
+	/// Force the compiler to treat the value as used so the work that produced it is not removed
+	/// </summary>
+	export template<typename T>
+	inline void DoNotOptimize(const T& value)
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		// Publish the address through a volatile store, the barrier stops the reads from being reordered past it
+		static const volatile void* sink = nullptr;
+		sink = &value;
+		_ReadWriteBarrier();
+#else
+		asm volatile("" : : "r,m"(value) : "memory");
+#endif
+	}
+
+	/// <summary>
+	/// Force the compiler to assume all memory was read and written so pending stores are not removed
+	/// </summary>
+	export inline void ClobberMemory()
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		_ReadWriteBarrier();
+#else
+		asm volatile("" : : : "memory");
+#endif
+	}
+
+	/// <summary>
+	/// The iteration loop of a benchmark that does its own setup, the setup runs once per batch of iterations.
+	/// A benchmark method that takes the state runs its measured body once per element:
+	///	for (auto iteration : state) { ... }
+	/// </summary>
+	export class BenchmarkState
+	{
+	public:
+		/// <summary>
+		/// An empty element so the loop variable costs nothing
+		/// </summary>
+		struct Iteration
+		{
+			// A user provided destructor keeps the unused loop variable from being reported as set but not used
+			~Iteration()
+			{
+			}
+		};
+
+		class Iterator
+		{
+		public:
+			Iterator(size_t remaining) :
+				m_remaining(remaining)
+			{
+			}
+
+			Iteration operator*() const
+			{
+				return Iteration();
+			}
+
+			Iterator& operator++()
+			{
+				m_remaining--;
+				return *this;
+			}
+
+			bool operator!=(const Iterator& rhs) const
+			{
+				return m_remaining != rhs.m_remaining;
+			}
+
+		private:
+			size_t m_remaining;
+		};
+
+		BenchmarkState(size_t iterations) :
+			m_iterations(iterations)
+		{
+		}
+
+		size_t GetIterations() const
+		{
+			return m_iterations;
+		}
+
+		Iterator begin() const
+		{
+			return Iterator(m_iterations);
+		}
+
+		Iterator end() const
+		{
+			return Iterator(0);
+		}
+
+	private:
+		size_t m_iterations;
+	};
+
+	template<typename TMethod>
+	struct BenchmarkMethodTraits;
+
+	template<typename TClass, typename TResult, typename... TArguments>
+	struct BenchmarkMethodTraits<TResult (TClass::*)(TArguments...)>
+	{
+		using Class = TClass;
+	};
+
+	template<typename TClass, typename TResult, typename... TArguments>
+	struct BenchmarkMethodTraits<TResult (TClass::*)(TArguments...) const>
+	{
+		using Class = TClass;
+	};
+
+	template<typename TClass, typename TResult, typename... TArguments>
+	struct BenchmarkMethodTraits<TResult (TClass::*)(TArguments...) noexcept>
+	{
+		using Class = TClass;
+	};
+
+	template<typename TClass, typename TResult, typename... TArguments>
+	struct BenchmarkMethodTraits<TResult (TClass::*)(TArguments...) const noexcept>
+	{
+		using Class = TClass;
+	};
+
+	/// <summary>
+	/// Invoke the benchmark method for the requested number of iterations.
+	/// A method without parameters is the measured body itself and is called once per iteration,
+	/// a method that takes a BenchmarkState runs the iterations itself.
+	/// </summary>
+	export template<auto Method>
+	void InvokeBenchmark(void* testClass, size_t iterations)
+	{
+		using Class = typename BenchmarkMethodTraits<decltype(Method)>::Class;
+		auto instance = static_cast<Class*>(testClass);
+		if constexpr (std::is_invocable_v<decltype(Method), Class*, BenchmarkState&>)
+		{
+			auto state = BenchmarkState(iterations);
+			(instance->*Method)(state);
+		}
+		else
+		{
+			for (size_t i = 0; i < iterations; i++)
+				(instance->*Method)();
+		}
+	}
+}
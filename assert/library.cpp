@@ -1,12 +1,77 @@
 module;
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <concepts>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <initializer_list>
 #include <iostream>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <new>
+#include <ranges>
+#include <span>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 
+#ifndef _WIN32
+#include <cerrno>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <fcntl.h>
+#endif
+
+#ifdef __GLIBC__
+#include <execinfo.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// The replaced global allocation functions must be attached to the global module
+#include "allocation-hooks.h"
+
 export module Soup.Test.Assert;
 
+#include "allocation-scope.h"
 #include "soup-assert.h"
-#include "run-test.h"
\ No newline at end of file
+#include "test-fixture.h"
+#include "run-test.h"
+#include "benchmark.h"
+#include "test-filter.h"
+#include "test-report.h"
+#include "test-reporter.h"
+#include "test-watchdog.h"
+#include "benchmark-runner.h"
+#include "benchmark-baseline.h"
+#include "test-scheduler.h"
+#include "test-harness-options.h"
+#include "test-harness.h"
\ No newline at end of file
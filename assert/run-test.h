@@ -15,35 +15,253 @@ namespace Soup::Test
 		}
 	};
 
-	export template<typename T>
-	TestState RunTest(
-		std::string className,
-		std::string testName,
-		T test)
+	/// <summary>
+	/// The source text of the arguments for a single theory row
+	/// </summary>
+	export using TheoryRowName = std::string_view;
+
+	/// <summary>
+	/// The reported name of a test, a theory row appends its arguments only when it is written
+	/// </summary>
+	export struct TestCaseName
+	{
+		std::string_view Name;
+		const TheoryRowName* RowName;
+
+		std::string ToString() const
+		{
+			auto result = std::string(Name);
+			if (RowName != nullptr)
+			{
+				result += "(";
+				result += *RowName;
+				result += ")";
+			}
+
+			return result;
+		}
+	};
+
+	export std::ostream& operator<<(std::ostream& stream, const TestCaseName& testCaseName)
+	{
+		stream << testCaseName.Name;
+		if (testCaseName.RowName != nullptr)
+			stream << "(" << *testCaseName.RowName << ")";
+
+		return stream;
+	}
+
+	/// <summary>
+	/// Guards the console so the report of a failure from one worker is never split by another
+	/// </summary>
+	std::mutex& GetOutputMutex()
+	{
+		static auto outputMutex = std::mutex();
+		return outputMutex;
+	}
+
+	/// <summary>
+	/// Run a single test and capture the reason it failed
+	/// </summary>
+	template<typename T>
+	bool TryRunTestCase(T& test, std::string& failureMessage)
 	{
 		try
 		{
-			// std::cout << "Running: " << className << "::" << testName << std::endl;
 			test();
-			// std::cout << "PASS: " << className << "::" << testName << std::endl;
-			return TestState{ 0, 1 };
+			return true;
 		}
 		catch (std::exception& ex)
 		{
-			std::cout << "FAIL: " << className << "::" << testName << std::endl;
 			// TODO: std::cout << typeid(ex).name() << std::endl;
-
-			if (!std::string(ex.what()).empty())
-			{
-				std::cout << ex.what() << std::endl;
-			}
+			failureMessage = ex.what();
 		}
 		catch (...)
 		{
-			std::cout << "FAIL: " << className << "::" << testName << std::endl;
-			std::cout << "Unknown error..." << std::endl;
+			failureMessage = "Unknown error...";
 		}
 
+		return false;
+	}
+
+	template<typename TName>
+	void ReportFailure(
+		std::string_view className,
+		const TName& testName,
+		std::string_view failureMessage)
+	{
+		auto message = std::stringstream();
+		message << "FAIL: " << className << "::" << testName << "\n";
+		if (!failureMessage.empty())
+		{
+			message << failureMessage << "\n";
+		}
+
+		auto lock = std::lock_guard<std::mutex>(GetOutputMutex());
+		std::cout << message.str() << std::flush;
+	}
+
+	template<typename TName, typename T>
+	TestState RunTestCase(
+		std::string_view className,
+		const TName& testName,
+		T test)
+	{
+		auto failureMessage = std::string();
+		if (TryRunTestCase(test, failureMessage))
+			return TestState{ 0, 1 };
+
+		ReportFailure(className, testName, failureMessage);
 		return TestState{ 1, 0 };
 	}
+
+	export template<typename T>
+	TestState RunTest(
+		std::string_view className,
+		std::string_view testName,
+		T test)
+	{
+		return RunTestCase(className, testName, std::move(test));
+	}
+
+	/// <summary>
+	/// How the tests of a class may be scheduled against each other and against the rest of the run.
+	/// Every test of a class shares a single instance, so the tests of a class run one at a time unless
+	/// the class opts into Parallel, or out of the default, with a static constexpr TestExecution Execution member.
+	/// </summary>
+	export enum class TestExecution
+	{
+		// Every test may run at the same time as any other test, including the other tests of the class on the shared instance
+		Parallel,
+
+		// The default, the tests of the class run one at a time in order, alongside the tests of other classes
+		Serialized,
+
+		// The tests of the class run one at a time with nothing else running
+		NotThreadSafe,
+	};
+
+	template<typename T>
+	concept HasTestExecution = requires
+	{
+		{ T::Execution } -> std::convertible_to<TestExecution>;
+	};
+
+	export template<typename T>
+	constexpr TestExecution TestClassExecution = TestExecution::Serialized;
+
+	export template<HasTestExecution T>
+	constexpr TestExecution TestClassExecution<T> = T::Execution;
+
+	/// <summary>
+	/// The type erased factory for a test class and the collection fixtures it shares with other classes
+	/// </summary>
+	export struct TestClassDescriptor
+	{
+		std::string_view Name;
+		void* (*Create)();
+		void (*Destroy)(void* testClass);
+		TestExecution Execution;
+		std::span<const CollectionFixtureReference> CollectionFixtures = {};
+	};
+
+	/// <summary>
+	/// Keep the collection fixtures of the class alive until the matching release, after its last test
+	/// </summary>
+	void RetainCollectionFixtures(const TestClassDescriptor& testClass)
+	{
+		for (auto& fixture : testClass.CollectionFixtures)
+			fixture.Retain();
+	}
+
+	void ReleaseCollectionFixtures(const TestClassDescriptor& testClass)
+	{
+		for (auto& fixture : testClass.CollectionFixtures)
+			fixture.Release();
+	}
+
+	/// <summary>
+	/// A single registered test that invokes its method on an instance of the class at ClassIndex.
+	/// A fact has no row names and runs once, a theory runs once for each of its rows.
+	/// A benchmark is never part of a test run, its invoke runs the given number of iterations in place of a row.
+	/// A timeout of zero leaves the test to the timeout of the run.
+	/// </summary>
+	export struct TestDescriptor
+	{
+		std::string_view Name;
+		size_t ClassIndex;
+		void (*Invoke)(void* testClass, size_t row);
+		std::span<const TheoryRowName> RowNames;
+		bool IsBenchmark = false;
+		uint32_t TimeoutMilliseconds = 0;
+	};
+
+	/// <summary>
+	/// A static table of test classes and the tests that run against them
+	/// </summary>
+	export struct TestTable
+	{
+		std::span<const TestClassDescriptor> Classes;
+		std::span<const TestDescriptor> Tests;
+	};
+
+	export template<typename T>
+	void* CreateTestClass()
+	{
+		return new T();
+	}
+
+	export template<typename T>
+	void DestroyTestClass(void* testClass)
+	{
+		delete static_cast<T*>(testClass);
+	}
+
+	template<typename TMethod>
+	struct TheoryMethodTraits;
+
+	template<typename TClass, typename TResult, typename... TArguments>
+	struct TheoryMethodTraits<TResult (TClass::*)(TArguments...)>
+	{
+		using Class = TClass;
+		using Row = std::tuple<std::remove_cvref_t<TArguments>...>;
+	};
+
+	template<typename TClass, typename TResult, typename... TArguments>
+	struct TheoryMethodTraits<TResult (TClass::*)(TArguments...) const>
+	{
+		using Class = TClass;
+		using Row = std::tuple<std::remove_cvref_t<TArguments>...>;
+	};
+
+	template<typename TClass, typename TResult, typename... TArguments>
+	struct TheoryMethodTraits<TResult (TClass::*)(TArguments...) noexcept>
+	{
+		using Class = TClass;
+		using Row = std::tuple<std::remove_cvref_t<TArguments>...>;
+	};
+
+	template<typename TClass, typename TResult, typename... TArguments>
+	struct TheoryMethodTraits<TResult (TClass::*)(TArguments...) const noexcept>
+	{
+		using Class = TClass;
+		using Row = std::tuple<std::remove_cvref_t<TArguments>...>;
+	};
+
+	/// <summary>
+	/// The stored arguments for a single row of a theory, one element per method parameter
+	/// </summary>
+	export template<auto Method>
+	using TheoryRow = typename TheoryMethodTraits<decltype(Method)>::Row;
+
+	/// <summary>
+	/// Invoke the theory method with the arguments of a single row
+	/// </summary>
+	export template<auto Method>
+	void InvokeTheory(void* testClass, const TheoryRow<Method>& row)
+	{
+		using Class = typename TheoryMethodTraits<decltype(Method)>::Class;
+		auto instance = static_cast<Class*>(testClass);
+		std::apply([instance](const auto&... arguments) { (instance->*Method)(arguments...); }, row);
+	}
 }
\ No newline at end of file
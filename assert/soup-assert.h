@@ -2,6 +2,35 @@
 
 namespace Soup::Test
 {
+	/// <summary>
+	/// The allowed difference between two floating point values, a pair is equal when it is within either bound
+	/// </summary>
+	export struct FloatTolerance
+	{
+		// The largest absolute difference
+		double Absolute = 0;
+
+		// The largest number of representable values between the pair
+		uint64_t Ulps = 0;
+	};
+
+	template<typename T>
+	concept AssertStreamable = requires(std::ostream& stream, const T& value)
+	{
+		stream << value;
+	};
+
+	/// <summary>
+	/// Two contiguous ranges of the same element type, text has its own overloads
+	/// </summary>
+	template<typename TExpected, typename TActual>
+	concept AssertContiguousRanges =
+		std::ranges::contiguous_range<const TExpected> &&
+		std::ranges::contiguous_range<const TActual> &&
+		std::same_as<std::ranges::range_value_t<const TExpected>, std::ranges::range_value_t<const TActual>> &&
+		!std::convertible_to<const TExpected&, std::string_view> &&
+		!std::convertible_to<const TActual&, std::string_view>;
+
 	export class Assert
 	{
 	public:
@@ -44,6 +73,32 @@ namespace Soup::Test
 			throw std::runtime_error("Should not hit this");
 		}
 
+		template<typename TFunc>
+		static AllocationStats NoAllocations(TFunc test)
+		{
+			return AllocatesAtMost(0, std::move(test));
+		}
+
+		template<typename TFunc>
+		static AllocationStats AllocatesAtMost(size_t count, TFunc test)
+		{
+			if (!IsAllocationTrackingEnabled())
+				Fail("Allocation tracking is disabled, build the test runtime with SOUP_TEST_ENABLE_ALLOCATION_HOOKS.");
+
+			auto scope = AllocationScope();
+			test();
+			auto stats = scope.GetStats();
+			if (stats.Count > count)
+			{
+				auto errorExpected = std::stringstream();
+				errorExpected << "Expected at most " << count << " allocations" <<
+					" Actual<" << stats.Count << " allocations of " << stats.Bytes << " bytes>";
+				Fail(errorExpected.str());
+			}
+
+			return stats;
+		}
+
 		template<typename T> struct is_shared_ptr : std::false_type {};
 		template<typename T> struct is_shared_ptr<std::shared_ptr<T>> : std::true_type {};
 
@@ -135,17 +190,16 @@ namespace Soup::Test
 			const std::vector<T>& actual,
 			std::string_view message)
 		{
-			if (expected.size() != actual.size())
+			if constexpr (std::ranges::contiguous_range<const std::vector<T>>)
 			{
-				auto errorExpected = std::stringstream();
-				errorExpected << message <<
-					" Size does not match [" <<
-					expected.size() << ", " <<
-					actual.size() << "]";
-				Fail(errorExpected.str());
+				AreElementsEqual<T>(expected, actual, message);
 			}
 			else
 			{
+				// std::vector<bool> packs its elements into bits, there is no span to compare in bulk
+				if (expected.size() != actual.size())
+					FailSize(expected.size(), actual.size(), message);
+
 				for (size_t i = 0; i < expected.size(); i++)
 				{
 					Assert::AreEqual(expected[i], actual[i], message);
@@ -153,6 +207,70 @@ namespace Soup::Test
 			}
 		}
 
+		template<typename T, size_t Size>
+		static void AreEqual(
+			const std::array<T, Size>& expected,
+			const std::array<T, Size>& actual,
+			std::string_view message)
+		{
+			AreElementsEqual<T>(expected, actual, message);
+		}
+
+		template<typename T, size_t Extent>
+		static void AreEqual(
+			std::span<T, Extent> expected,
+			std::span<T, Extent> actual,
+			std::string_view message)
+		{
+			AreElementsEqual<std::remove_cv_t<T>>(expected, actual, message);
+		}
+
+		/// <summary>
+		/// Compare any two contiguous ranges element by element, such as an array against a vector
+		/// </summary>
+		template<typename TExpected, typename TActual>
+			requires AssertContiguousRanges<TExpected, TActual>
+		static void AreEqual(
+			const TExpected& expected,
+			const TActual& actual,
+			std::string_view message)
+		{
+			using T = std::ranges::range_value_t<const TExpected>;
+			AreElementsEqual<T>(
+				std::span<const T>(std::ranges::data(expected), std::ranges::size(expected)),
+				std::span<const T>(std::ranges::data(actual), std::ranges::size(actual)),
+				message);
+		}
+
+		/// <summary>
+		/// Compare two contiguous ranges of float or double, every pair must be within the tolerance.
+		/// NaN is never equal to anything.
+		/// </summary>
+		template<typename TExpected, typename TActual>
+			requires AssertContiguousRanges<TExpected, TActual> &&
+				(std::same_as<std::ranges::range_value_t<const TExpected>, float> ||
+					std::same_as<std::ranges::range_value_t<const TExpected>, double>)
+		static void AreEqual(
+			const TExpected& expected,
+			const TActual& actual,
+			FloatTolerance tolerance,
+			std::string_view message)
+		{
+			using T = std::ranges::range_value_t<const TExpected>;
+			auto expectedValues = std::span<const T>(std::ranges::data(expected), std::ranges::size(expected));
+			auto actualValues = std::span<const T>(std::ranges::data(actual), std::ranges::size(actual));
+			if (expectedValues.size() != actualValues.size())
+				FailSize(expectedValues.size(), actualValues.size(), message);
+
+			auto index = FindMismatch(expectedValues, actualValues, tolerance);
+			if (index != expectedValues.size())
+			{
+				auto detail = std::stringstream();
+				detail << " outside tolerance (absolute " << tolerance.Absolute << ", ulps " << tolerance.Ulps << ")";
+				FailMismatch(expectedValues, actualValues, index, detail.str(), message);
+			}
+		}
+
 		template<typename T>
 		static typename std::enable_if<std::is_pointer<T>::value || is_shared_ptr<T>::value>::type AreNotEqual(
 			T expected,
@@ -184,5 +302,195 @@ namespace Soup::Test
 				Fail(message);
 			}
 		}
+
+	private:
+		// The number of elements shown on each side of the first mismatch
+		static constexpr size_t MismatchRadius = 4;
+
+		template<typename T>
+		static void AreElementsEqual(
+			std::span<const T> expected,
+			std::span<const T> actual,
+			std::string_view message)
+		{
+			if (expected.size() != actual.size())
+				FailSize(expected.size(), actual.size(), message);
+
+			if constexpr (std::is_pointer<T>::value || is_shared_ptr<T>::value)
+			{
+				// Pointers compare the values they point at
+				auto pointerMessage = std::string(message);
+				for (size_t i = 0; i < expected.size(); i++)
+					Assert::AreEqual(expected[i], actual[i], pointerMessage);
+			}
+			else
+			{
+				auto index = FindMismatch(expected, actual);
+				if (index != expected.size())
+					FailMismatch(expected, actual, index, std::string_view(), message);
+			}
+		}
+
+		/// <summary>
+		/// The index of the first pair that is not equal, the size when every pair is
+		/// </summary>
+		template<typename T>
+		static size_t FindMismatch(std::span<const T> expected, std::span<const T> actual)
+		{
+			size_t index = 0;
+			if constexpr (std::is_scalar_v<T> && std::has_unique_object_representations_v<T>)
+			{
+				// Equal values have equal bytes, so the vectorized memcmp checks everything at once
+				// and on a mismatch narrows it down to a block before comparing single elements
+				constexpr size_t BlockSize = std::max<size_t>(256 / sizeof(T), 1);
+				if (expected.empty() || std::memcmp(expected.data(), actual.data(), expected.size_bytes()) == 0)
+					return expected.size();
+
+				while (index + BlockSize <= expected.size() &&
+					std::memcmp(expected.data() + index, actual.data() + index, BlockSize * sizeof(T)) == 0)
+				{
+					index += BlockSize;
+				}
+			}
+
+			while (index < expected.size() && expected[index] == actual[index])
+				index++;
+
+			return index;
+		}
+
+		template<typename T>
+		static size_t FindMismatch(std::span<const T> expected, std::span<const T> actual, FloatTolerance tolerance)
+		{
+			using TBits = std::conditional_t<sizeof(T) == sizeof(uint32_t), uint32_t, uint64_t>;
+			auto absolute = static_cast<T>(tolerance.Absolute);
+			auto ulps = static_cast<TBits>(std::min<uint64_t>(tolerance.Ulps, std::numeric_limits<TBits>::max()));
+
+			// Each block is checked without branches so the compiler can vectorize it, only a failing block is searched
+			constexpr size_t BlockSize = 64;
+			size_t index = 0;
+			while (index < expected.size())
+			{
+				auto blockEnd = std::min(index + BlockSize, expected.size());
+				uint32_t mismatchCount = 0;
+				for (auto i = index; i < blockEnd; i++)
+					mismatchCount += !IsWithin<T, TBits>(expected[i], actual[i], absolute, ulps);
+
+				if (mismatchCount > 0)
+					break;
+
+				index = blockEnd;
+			}
+
+			while (index < expected.size() && IsWithin<T, TBits>(expected[index], actual[index], absolute, ulps))
+				index++;
+
+			return index;
+		}
+
+		template<typename T, typename TBits>
+		static bool IsWithin(T expected, T actual, T absolute, TBits ulps)
+		{
+			// Infinities are only equal to themselves, NaN to nothing
+			auto isNumber = (expected == expected) & (actual == actual);
+			auto isAbsolute = std::abs(expected - actual) <= absolute;
+			auto orderedExpected = ToOrderedBits<T, TBits>(expected);
+			auto orderedActual = ToOrderedBits<T, TBits>(actual);
+			auto distance = orderedExpected > orderedActual ? orderedExpected - orderedActual : orderedActual - orderedExpected;
+			return (expected == actual) | (isNumber & (isAbsolute | (distance <= ulps)));
+		}
+
+		/// <summary>
+		/// Map the sign and magnitude bits onto a single increasing line so neighbouring values differ by one,
+		/// negative values count down from the sign bit which leaves both zeros on the same point
+		/// </summary>
+		template<typename T, typename TBits>
+		static TBits ToOrderedBits(T value)
+		{
+			constexpr auto SignBit = static_cast<TBits>(TBits(1) << (sizeof(TBits) * 8 - 1));
+			auto bits = std::bit_cast<TBits>(value);
+			return (bits & SignBit) != 0 ? static_cast<TBits>(~bits + 1) : static_cast<TBits>(bits | SignBit);
+		}
+
+		static void FailSize(size_t expectedSize, size_t actualSize, std::string_view message)
+		{
+			auto errorExpected = std::stringstream();
+			errorExpected << message <<
+				" Size does not match [" <<
+				expectedSize << ", " <<
+				actualSize << "]";
+			Fail(errorExpected.str());
+		}
+
+		/// <summary>
+		/// Report the first mismatch with the elements around it, as values when they can be written and as bytes otherwise
+		/// </summary>
+		template<typename T>
+		static void FailMismatch(
+			std::span<const T> expected,
+			std::span<const T> actual,
+			size_t index,
+			std::string_view detail,
+			std::string_view message)
+		{
+			auto errorExpected = std::stringstream();
+			errorExpected << message << " Mismatch at index " << index << " of " << expected.size() << detail;
+			if constexpr (AssertStreamable<T> || std::is_trivially_copyable_v<T>)
+			{
+				auto begin = index > MismatchRadius ? index - MismatchRadius : 0;
+				auto end = std::min(index + MismatchRadius + 1, expected.size());
+				errorExpected << " Expected<";
+				WriteElements(expected, begin, end, errorExpected);
+				errorExpected << "> Actual<";
+				WriteElements(actual, begin, end, errorExpected);
+				errorExpected << ">";
+			}
+
+			Fail(errorExpected.str());
+		}
+
+		template<typename T>
+		static void WriteElements(std::span<const T> values, size_t begin, size_t end, std::ostream& stream)
+		{
+			if (begin > 0)
+				stream << "... ";
+
+			for (auto i = begin; i < end; i++)
+			{
+				if (i > begin)
+					stream << ", ";
+				WriteElement(values[i], stream);
+			}
+
+			if (end < values.size())
+				stream << " ...";
+		}
+
+		template<typename T>
+		static void WriteElement(const T& value, std::ostream& stream)
+		{
+			if constexpr (std::is_floating_point_v<T>)
+			{
+				stream << std::setprecision(std::numeric_limits<T>::max_digits10) << value;
+			}
+			else if constexpr (std::is_integral_v<T>)
+			{
+				// Promote the character types so they are written as numbers
+				stream << +value;
+			}
+			else if constexpr (AssertStreamable<T>)
+			{
+				stream << value;
+			}
+			else
+			{
+				// 0x[BYTES] in memory order
+				auto bytes = reinterpret_cast<const unsigned char*>(&value);
+				stream << "0x" << std::hex << std::setfill('0');
+				for (size_t i = 0; i < sizeof(T); i++)
+					stream << std::setw(2) << static_cast<int>(bytes[i]);
+				stream << std::dec << std::setfill(' ');
+			}
+		}
 	};
 }
\ No newline at end of file
@@ -0,0 +1,127 @@
+#pragma once
+
+namespace Soup::Test
+{
+	/// <summary>
+	/// Selects tests by glob patterns over their full names, Namespace::Class::Method for a test
+	/// and Namespace::Class::Method(Arguments) for a single theory row, where a theory also matches
+	/// on its method name alone. A '*' matches any run of characters and a '?' matches one character.
+	/// A pattern with a leading '-' excludes the tests it matches, and with no including pattern every test is included.
+	/// The names are matched piece by piece in place so a rejected test never builds a string.
+	/// </summary>
+	export class TestFilter
+	{
+	public:
+		void Add(std::string_view pattern)
+		{
+			if (pattern.starts_with('-'))
+				m_excludes.emplace_back(pattern.substr(1));
+			else
+				m_includes.emplace_back(pattern);
+		}
+
+		bool IsEmpty() const
+		{
+			return m_includes.empty() && m_excludes.empty();
+		}
+
+		bool IsMatch(std::string_view className, std::string_view testName, const TheoryRowName* rowName) const
+		{
+			if (IsEmpty())
+				return true;
+
+			auto name = TestName({ className, "::", testName });
+			auto rowCaseName = TestName({ className, "::", testName, "(", rowName != nullptr ? *rowName : "", ")" });
+			auto isMatch = [&](const std::string& pattern)
+			{
+				return IsGlobMatch(pattern, name) || (rowName != nullptr && IsGlobMatch(pattern, rowCaseName));
+			};
+
+			auto isIncluded = m_includes.empty() || std::any_of(m_includes.begin(), m_includes.end(), isMatch);
+			return isIncluded && std::none_of(m_excludes.begin(), m_excludes.end(), isMatch);
+		}
+
+	private:
+		/// <summary>
+		/// A name made of a few pieces that are read as if they were joined
+		/// </summary>
+		class TestName
+		{
+		public:
+			TestName(std::initializer_list<std::string_view> parts) :
+				m_parts(),
+				m_partCount(0),
+				m_size(0)
+			{
+				for (auto part : parts)
+				{
+					m_parts[m_partCount++] = part;
+					m_size += part.size();
+				}
+			}
+
+			size_t GetSize() const
+			{
+				return m_size;
+			}
+
+			char GetCharacter(size_t offset) const
+			{
+				for (size_t i = 0; i < m_partCount; i++)
+				{
+					if (offset < m_parts[i].size())
+						return m_parts[i][offset];
+
+					offset -= m_parts[i].size();
+				}
+
+				return '\0';
+			}
+
+		private:
+			std::array<std::string_view, 6> m_parts;
+			size_t m_partCount;
+			size_t m_size;
+		};
+
+		static bool IsGlobMatch(std::string_view pattern, const TestName& name)
+		{
+			// Greedy match that backtracks only to the most recent star, linear for patterns without stars
+			size_t patternOffset = 0;
+			size_t nameOffset = 0;
+			auto starOffset = std::string_view::npos;
+			size_t starNameOffset = 0;
+			while (nameOffset < name.GetSize())
+			{
+				if (patternOffset < pattern.size() && pattern[patternOffset] == '*')
+				{
+					starOffset = patternOffset++;
+					starNameOffset = nameOffset;
+				}
+				else if (patternOffset < pattern.size() &&
+					(pattern[patternOffset] == '?' || pattern[patternOffset] == name.GetCharacter(nameOffset)))
+				{
+					patternOffset++;
+					nameOffset++;
+				}
+				else if (starOffset != std::string_view::npos)
+				{
+					patternOffset = starOffset + 1;
+					nameOffset = ++starNameOffset;
+				}
+				else
+				{
+					return false;
+				}
+			}
+
+			while (patternOffset < pattern.size() && pattern[patternOffset] == '*')
+				patternOffset++;
+
+			return patternOffset == pattern.size();
+		}
+
+		std::vector<std::string> m_includes;
+		std::vector<std::string> m_excludes;
+	};
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+namespace Soup::Test
+{
+	/// <summary>
+	/// The single instance of a collection fixture type in this process.
+	/// Every test class that depends on the fixture holds a reference for as long as it has tests left to run,
+	/// the fixture is created by the first access and destroyed when the last reference is released.
+	/// </summary>
+	template<typename TFixture>
+	class CollectionFixtureInstance
+	{
+	public:
+		CollectionFixtureInstance() :
+			m_mutex(),
+			m_instance(nullptr),
+			m_referenceCount(0)
+		{
+		}
+
+		/// <summary>
+		/// Create the fixture on first use, a failed create leaves it unset so the next access tries again
+		/// </summary>
+		TFixture& Get()
+		{
+			auto instance = m_instance.load(std::memory_order_acquire);
+			if (instance != nullptr)
+				return *instance;
+
+			auto lock = std::lock_guard<std::mutex>(m_mutex);
+			instance = m_instance.load(std::memory_order_relaxed);
+			if (instance == nullptr)
+			{
+				instance = new TFixture();
+				m_instance.store(instance, std::memory_order_release);
+			}
+
+			return *instance;
+		}
+
+		void Retain()
+		{
+			auto lock = std::lock_guard<std::mutex>(m_mutex);
+			m_referenceCount++;
+		}
+
+		void Release()
+		{
+			auto lock = std::lock_guard<std::mutex>(m_mutex);
+			if (m_referenceCount > 0 && --m_referenceCount == 0)
+			{
+				delete m_instance.load(std::memory_order_relaxed);
+				m_instance.store(nullptr, std::memory_order_relaxed);
+			}
+		}
+
+	private:
+		std::mutex m_mutex;
+		std::atomic<TFixture*> m_instance;
+		size_t m_referenceCount;
+	};
+
+	template<typename TFixture>
+	CollectionFixtureInstance<TFixture>& GetCollectionFixtureInstance()
+	{
+		static auto instance = CollectionFixtureInstance<TFixture>();
+		return instance;
+	}
+
+	/// <summary>
+	/// The type erased reference counting of a single collection fixture, held by the descriptor of every class that depends on it
+	/// </summary>
+	export struct CollectionFixtureReference
+	{
+		void (*Retain)();
+		void (*Release)();
+	};
+
+	/// <summary>
+	/// The common base of every CollectionFixture, which still identifies a class that derives from more than one of them
+	/// </summary>
+	class CollectionFixtureBase
+	{
+	};
+
+	/// <summary>
+	/// Declares fixtures that are shared by every test class that declares the same fixture type.
+	/// Each fixture is default constructed by the first test that gets it, from any thread, and destroyed once
+	/// the last of the classes that declare it has finished its tests. Derive from it to declare the fixtures:
+	///	class DatasetTests : public Soup::Test::CollectionFixture<LargeDataset>
+	/// </summary>
+	export template<typename... TFixtures>
+		requires (sizeof...(TFixtures) > 0)
+	class CollectionFixture : public CollectionFixtureBase
+	{
+	public:
+		template<typename TFixture>
+			requires (std::same_as<TFixture, TFixtures> || ...)
+		TFixture& GetCollectionFixture() const
+		{
+			return GetCollectionFixtureInstance<TFixture>().Get();
+		}
+	};
+
+	/// <summary>
+	/// The single instance of a class fixture, owned by the test class that declares it
+	/// </summary>
+	template<typename TFixture>
+	class ClassFixtureInstance
+	{
+	public:
+		ClassFixtureInstance() :
+			m_createFlag(),
+			m_instance()
+		{
+		}
+
+		TFixture& Get()
+		{
+			// A failed create leaves the flag unset so the next access tries again
+			std::call_once(m_createFlag, [this]() { m_instance = std::make_unique<TFixture>(); });
+			return *m_instance;
+		}
+
+	private:
+		std::once_flag m_createFlag;
+		std::unique_ptr<TFixture> m_instance;
+	};
+
+	/// <summary>
+	/// Declares fixtures that are shared by the tests of a single class.
+	/// Each fixture is default constructed by the first test of the class that gets it, from any thread,
+	/// and destroyed with the class once its last test has finished. Derive from it to declare the fixtures:
+	///	class ParserTests : public Soup::Test::ClassFixture<Grammar>
+	/// </summary>
+	export template<typename... TFixtures>
+		requires (sizeof...(TFixtures) > 0)
+	class ClassFixture
+	{
+	public:
+		template<typename TFixture>
+			requires (std::same_as<TFixture, TFixtures> || ...)
+		TFixture& GetClassFixture()
+		{
+			return std::get<ClassFixtureInstance<TFixture>>(m_fixtures).Get();
+		}
+
+	private:
+		std::tuple<ClassFixtureInstance<TFixtures>...> m_fixtures;
+	};
+
+	template<typename... TFixtures>
+	std::tuple<TFixtures...>* GetCollectionFixtureTypes(const CollectionFixture<TFixtures...>*);
+
+	template<typename T>
+	concept HasCollectionFixtures = requires(const T* testClass)
+	{
+		GetCollectionFixtureTypes(testClass);
+	};
+
+	template<typename TFixtureTypes>
+	struct CollectionFixtureReferences;
+
+	template<typename... TFixtures>
+	struct CollectionFixtureReferences<std::tuple<TFixtures...>>
+	{
+		static constexpr CollectionFixtureReference Values[] =
+		{
+			{
+				[]() { GetCollectionFixtureInstance<TFixtures>().Retain(); },
+				[]() { GetCollectionFixtureInstance<TFixtures>().Release(); },
+			}...
+		};
+	};
+
+	/// <summary>
+	/// Reject a class whose fixtures cannot be deduced from its CollectionFixture bases, such as a class with two of them,
+	/// which would otherwise run without holding any of its fixtures
+	/// </summary>
+	template<typename T>
+	consteval std::span<const CollectionFixtureReference> GetEmptyCollectionFixtures()
+	{
+		static_assert(
+			!std::is_base_of_v<CollectionFixtureBase, T>,
+			"A test class must have a single public CollectionFixture base, declare every fixture in it: CollectionFixture<A, B>");
+		return {};
+	}
+
+	/// <summary>
+	/// The collection fixtures a test class declares through its CollectionFixture base
+	/// </summary>
+	export template<typename T>
+	constexpr std::span<const CollectionFixtureReference> TestClassCollectionFixtures = GetEmptyCollectionFixtures<T>();
+
+	export template<HasCollectionFixtures T>
+	constexpr std::span<const CollectionFixtureReference> TestClassCollectionFixtures<T> =
+		CollectionFixtureReferences<std::remove_pointer_t<decltype(GetCollectionFixtureTypes(static_cast<const T*>(nullptr)))>>::Values;
+}
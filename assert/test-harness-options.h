@@ -0,0 +1,184 @@
+#pragma once
+
+namespace Soup::Test
+{
+	/// <summary>
+	/// The command line settings for a single test harness run
+	/// </summary>
+	export struct TestHarnessOptions
+	{
+		size_t WorkerCount = 1;
+		size_t ShardIndex = 0;
+		size_t ShardCount = 1;
+		size_t ProcessCount = 1;
+		std::vector<std::string> Filters;
+		bool List = false;
+		size_t SlowestCount = 10;
+		TestReportFormat ReportFormat = TestReportFormat::None;
+		std::string ReportFile;
+		bool SampleMemory = false;
+		size_t MemoryLimitBytes = 0;
+		size_t TimeoutSeconds = 0;
+		bool Benchmarks = false;
+		BenchmarkOptions Benchmark;
+		std::string BenchmarkBaselineFile;
+		std::string BenchmarkSaveFile;
+		double BenchmarkThreshold = 0.1;
+
+		static TestHarnessOptions Parse(int argc, char** argv)
+		{
+			auto options = TestHarnessOptions();
+			for (int i = 1; i < argc; i++)
+			{
+				auto argument = std::string_view(argv[i]);
+				if (argument == "-j")
+				{
+					if (i + 1 >= argc)
+						throw std::runtime_error("Missing worker count for -j.");
+					options.WorkerCount = ParseCount(argv[++i], "worker count");
+				}
+				else if (argument.starts_with("-j"))
+				{
+					options.WorkerCount = ParseCount(argument.substr(2), "worker count");
+				}
+				else if (argument.starts_with("--shard="))
+				{
+					ParseShard(argument.substr(8), options);
+				}
+				else if (argument.starts_with("--processes="))
+				{
+					options.ProcessCount = ParseCount(argument.substr(12), "process count");
+				}
+				else if (argument.starts_with("--filter="))
+				{
+					// Repeat the argument for more patterns, a separator would collide with the theory arguments
+					options.Filters.emplace_back(argument.substr(9));
+				}
+				else if (argument == "--list")
+				{
+					options.List = true;
+				}
+				else if (argument.starts_with("--slowest="))
+				{
+					// Zero turns the summary off
+					options.SlowestCount = ParseUnsigned(argument.substr(10), "slowest count");
+				}
+				else if (argument.starts_with("--report="))
+				{
+					options.ReportFormat = ParseReportFormat(argument.substr(9));
+				}
+				else if (argument.starts_with("--report-file="))
+				{
+					options.ReportFile = argument.substr(14);
+				}
+				else if (argument == "--memory")
+				{
+					// Sample the resident set of every test, which runs the tests one at a time
+					options.SampleMemory = true;
+				}
+				else if (argument.starts_with("--memory-limit="))
+				{
+					// Fail every test whose resident set peaks above this many megabytes
+					options.MemoryLimitBytes = ParseUnsigned(argument.substr(15), "memory limit") * 1024 * 1024;
+				}
+				else if (argument.starts_with("--timeout="))
+				{
+					// The timeout of every test that does not set its own, zero only watches the tests that do
+					options.TimeoutSeconds = ParseUnsigned(argument.substr(10), "timeout");
+				}
+				else if (argument == "--benchmarks")
+				{
+					// Run the benchmarks instead of the tests
+					options.Benchmarks = true;
+				}
+				else if (argument.starts_with("--benchmark-time="))
+				{
+					auto milliseconds = ParsePositive(argument.substr(17), "benchmark time");
+					options.Benchmark.RepetitionTime = std::chrono::milliseconds(milliseconds);
+					options.Benchmark.WarmupTime = std::chrono::milliseconds(milliseconds);
+				}
+				else if (argument.starts_with("--benchmark-repetitions="))
+				{
+					options.Benchmark.RepetitionCount = ParsePositive(argument.substr(24), "benchmark repetitions");
+				}
+				else if (argument.starts_with("--benchmark-baseline="))
+				{
+					options.BenchmarkBaselineFile = argument.substr(21);
+				}
+				else if (argument.starts_with("--benchmark-save="))
+				{
+					options.BenchmarkSaveFile = argument.substr(17);
+				}
+				else if (argument.starts_with("--benchmark-threshold="))
+				{
+					// The slowdown of the median in percent that fails a benchmark
+					options.BenchmarkThreshold = ParseUnsigned(argument.substr(22), "benchmark threshold") / 100.0;
+				}
+				else
+				{
+					throw std::runtime_error("Unknown argument: " + std::string(argument));
+				}
+			}
+
+			if (!options.ReportFile.empty() && options.ReportFormat == TestReportFormat::None)
+				throw std::runtime_error("Missing report format for --report-file.");
+			if (options.ReportFile.empty() && options.ReportFormat != TestReportFormat::None)
+				options.ReportFile = options.ReportFormat == TestReportFormat::JUnit ? "test-results.xml" : "test-results.json";
+
+			return options;
+		}
+
+	private:
+		static void ParseShard(std::string_view value, TestHarnessOptions& options)
+		{
+			// --shard=[INDEX]/[COUNT]
+			auto separator = value.find('/');
+			if (separator == std::string_view::npos)
+				throw std::runtime_error("Invalid shard, expected index/count: " + std::string(value));
+
+			options.ShardIndex = ParseUnsigned(value.substr(0, separator), "shard index");
+			options.ShardCount = ParseUnsigned(value.substr(separator + 1), "shard count");
+			if (options.ShardCount == 0 || options.ShardIndex >= options.ShardCount)
+				throw std::runtime_error("Invalid shard: " + std::string(value));
+		}
+
+		static TestReportFormat ParseReportFormat(std::string_view value)
+		{
+			if (value == "junit")
+				return TestReportFormat::JUnit;
+			else if (value == "json")
+				return TestReportFormat::Json;
+			else
+				throw std::runtime_error("Unknown report format, expected junit or json: " + std::string(value));
+		}
+
+		static size_t ParseCount(std::string_view value, std::string_view name)
+		{
+			// Zero requests one per hardware thread
+			auto count = ParseUnsigned(value, name);
+			if (count == 0)
+				return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+			return count;
+		}
+
+		static size_t ParsePositive(std::string_view value, std::string_view name)
+		{
+			auto result = ParseUnsigned(value, name);
+			if (result == 0)
+				throw std::runtime_error("Invalid " + std::string(name) + ": " + std::string(value));
+
+			return result;
+		}
+
+		static size_t ParseUnsigned(std::string_view value, std::string_view name)
+		{
+			size_t result = 0;
+			auto parseResult = std::from_chars(value.data(), value.data() + value.size(), result);
+			if (value.empty() || parseResult.ec != std::errc() || parseResult.ptr != value.data() + value.size())
+				throw std::runtime_error("Invalid " + std::string(name) + ": " + std::string(value));
+
+			return result;
+		}
+	};
+}
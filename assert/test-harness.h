@@ -0,0 +1,458 @@
+#pragma once
+
+namespace Soup::Test
+{
+	/// <summary>
+	/// The entry point of a test harness executable.
+	/// Runs the selected shard of the registered tests in this process, or forks worker processes
+	/// that each run an interleaved slice of it and merges their counts and failure reports.
+	/// Finishes with the slowest test cases and optionally a JUnit or JSON report of every case.
+	/// The benchmarks are only run when requested, in place of the tests, and a benchmark that regressed
+	/// against the saved baseline fails the same as a test.
+	/// A test that runs past its timeout ends the run with TestWatchdog::TimeoutExitCode. A forked process streams
+	/// the result of every case as it finishes, the case that hung included, and is started again for the cases it never ran.
+	/// </summary>
+	export class TestHarness
+	{
+	public:
+		static int Run(int argc, char** argv, void (*addTests)(TestScheduler& scheduler))
+		{
+			try
+			{
+				auto options = TestHarnessOptions::Parse(argc, argv);
+				auto scheduler = TestScheduler(options.WorkerCount);
+				addTests(scheduler);
+
+				auto filter = TestFilter();
+				for (auto& pattern : options.Filters)
+					filter.Add(pattern);
+
+				if (options.Benchmarks)
+					return RunBenchmarks(scheduler.GetTables(), std::move(filter), options);
+
+				scheduler.SetFilter(std::move(filter));
+				scheduler.SetMemorySampling(options.SampleMemory);
+				scheduler.SetMemoryLimit(options.MemoryLimitBytes);
+				scheduler.SetTimeout(std::chrono::seconds(options.TimeoutSeconds));
+
+				if (options.List)
+				{
+					scheduler.SetShard(options.ShardIndex, options.ShardCount);
+					scheduler.List(std::cout);
+					std::cout.flush();
+					return 0;
+				}
+
+				TestState state;
+				auto results = std::vector<TestResult>();
+				auto startTime = std::chrono::steady_clock::now();
+				if (options.ProcessCount > 1)
+				{
+					state = RunProcesses(scheduler, options, results);
+				}
+				else
+				{
+					scheduler.SetShard(options.ShardIndex, options.ShardCount);
+					state = scheduler.Run(results);
+				}
+
+				auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
+					std::chrono::steady_clock::now() - startTime);
+
+				if (options.SlowestCount > 0)
+				{
+					TestReport::WriteSlowest(results, options.SlowestCount, std::cout);
+					TestReport::WriteMostAllocating(results, options.SlowestCount, std::cout);
+				}
+
+				return Complete(state, duration, results, options);
+			}
+			catch (const std::exception& ex)
+			{
+				std::cout << "ERROR: " << ex.what() << std::endl;
+				return -1;
+			}
+		}
+
+	private:
+		static int RunBenchmarks(
+			const std::vector<TestTable>& tables,
+			TestFilter filter,
+			const TestHarnessOptions& options)
+		{
+			// Splitting the machine would only add noise to the measurements
+			if (options.ProcessCount > 1 || options.ShardCount > 1)
+				throw std::runtime_error("Benchmarks always run in a single process.");
+
+			auto runner = BenchmarkRunner(options.Benchmark, std::move(filter));
+			if (options.List)
+			{
+				runner.List(tables, std::cout);
+				std::cout.flush();
+				return 0;
+			}
+
+			auto results = std::vector<TestResult>();
+			auto benchmarkResults = std::vector<BenchmarkResult>();
+			auto startTime = std::chrono::steady_clock::now();
+			auto state = runner.Run(tables, results, benchmarkResults);
+			auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - startTime);
+
+			BenchmarkRunner::WriteResults(benchmarkResults, std::cout);
+
+			if (!options.BenchmarkBaselineFile.empty())
+			{
+				auto baseline = BenchmarkBaseline::Load(options.BenchmarkBaselineFile);
+				auto comparisons = baseline.Compare(benchmarkResults, options.BenchmarkThreshold);
+				BenchmarkBaseline::WriteComparisons(comparisons, std::cout);
+				for (auto& comparison : comparisons)
+				{
+					if (comparison.IsRegression)
+						FailRegression(comparison, state, results);
+				}
+			}
+
+			if (!options.BenchmarkSaveFile.empty())
+				BenchmarkBaseline::Save(options.BenchmarkSaveFile, benchmarkResults);
+
+			return Complete(state, duration, results, options);
+		}
+
+		static void FailRegression(
+			const BenchmarkComparison& comparison,
+			TestState& state,
+			std::vector<TestResult>& results)
+		{
+			auto& benchmark = *comparison.Result;
+			auto message = BenchmarkBaseline::GetRegressionMessage(comparison);
+			ReportFailure(benchmark.Class->Name, benchmark.Test->Name, message);
+			state.PassCount--;
+			state.FailCount++;
+
+			for (auto& result : results)
+			{
+				if (result.TableIndex == benchmark.TableIndex && result.Test == benchmark.Test)
+				{
+					result.IsPass = false;
+					result.Message = message;
+				}
+			}
+		}
+
+		static int Complete(
+			const TestState& state,
+			std::chrono::nanoseconds duration,
+			const std::vector<TestResult>& results,
+			const TestHarnessOptions& options)
+		{
+			if (options.ReportFormat != TestReportFormat::None)
+				TestReport::Save(options.ReportFile, options.ReportFormat, state, duration, results);
+
+			std::cout << state.PassCount << " passed, " << state.FailCount << " failed." << std::endl;
+			return state.FailCount == 0 ? 0 : 1;
+		}
+
+#ifdef _WIN32
+		static TestState RunProcesses(TestScheduler&, const TestHarnessOptions&, std::vector<TestResult>&)
+		{
+			throw std::runtime_error("Running tests in multiple processes is not supported on this platform.");
+		}
+#else
+		/// <summary>
+		/// A forked worker, the read ends of its pipes and everything read from them
+		/// </summary>
+		struct TestProcess
+		{
+			size_t Process;
+			pid_t ProcessId;
+			int OutputPipe;
+			int ResultPipe;
+			std::string Output;
+			std::string Result;
+		};
+
+		static TestState RunProcesses(
+			TestScheduler& scheduler,
+			const TestHarnessOptions& options,
+			std::vector<TestResult>& results)
+		{
+			// Every case each process has reported, a process stopped by a timeout is started again
+			// for the rest of its slice until it completes or stops without reporting anything new
+			auto processResults = std::vector<std::vector<TestResult>>(options.ProcessCount);
+			auto pendingProcesses = std::vector<size_t>();
+			for (size_t process = 0; process < options.ProcessCount; process++)
+				pendingProcesses.push_back(process);
+
+			auto state = TestState{ 0, 0 };
+			while (!pendingProcesses.empty())
+			{
+				auto processes = std::vector<TestProcess>();
+				for (auto process : pendingProcesses)
+					processes.push_back(StartProcess(scheduler, options, process, processResults[process]));
+
+				pendingProcesses.clear();
+				ReadProcessPipes(processes);
+
+				// Report the processes in order so their failures never interleave
+				for (auto& testProcess : processes)
+				{
+					auto process = testProcess.Process;
+					std::cout << testProcess.Output;
+
+					int status = 0;
+					waitpid(testProcess.ProcessId, &status, 0);
+
+					// Keep every case the process finished, even when it did not get to the end
+					auto& finishedResults = processResults[process];
+					auto previousCount = finishedResults.size();
+					auto resultStream = std::istringstream(std::move(testProcess.Result));
+					state += ReadResults(scheduler, resultStream, finishedResults);
+					if (WIFEXITED(status) && WEXITSTATUS(status) == TestWatchdog::TimeoutExitCode)
+					{
+						// The process reported the test that timed out, any progress at all means it is safe to go again
+						if (finishedResults.size() > previousCount)
+						{
+							std::cout << "Test process " << process << " stopped after a test timed out, restarting it for the remaining tests" << std::endl;
+							pendingProcesses.push_back(process);
+						}
+						else
+						{
+							std::cout << "FAIL: Test process " << process << " stopped after a test timed out" << std::endl;
+							state.FailCount++;
+						}
+					}
+					else if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+					{
+						// The case that crashed has no result, report the process itself as failed
+						std::cout << "FAIL: Test process " << process << " did not complete" << std::endl;
+						state.FailCount++;
+					}
+				}
+			}
+
+			for (auto& finishedResults : processResults)
+				std::move(finishedResults.begin(), finishedResults.end(), std::back_inserter(results));
+
+			TestScheduler::SortResults(results);
+			return state;
+		}
+
+		/// <summary>
+		/// Fork a process for its slice of the current shard, leaving out the cases it already reported
+		/// </summary>
+		static TestProcess StartProcess(
+			TestScheduler& scheduler,
+			const TestHarnessOptions& options,
+			size_t process,
+			const std::vector<TestResult>& finishedResults)
+		{
+			// Nothing buffered before the fork may be written twice
+			std::cout.flush();
+
+			int outputPipe[2];
+			int resultPipe[2];
+			if (pipe(outputPipe) != 0)
+				throw std::runtime_error("Failed to create test process output pipe.");
+			if (pipe(resultPipe) != 0)
+				throw std::runtime_error("Failed to create test process result pipe.");
+
+			auto processId = fork();
+			if (processId < 0)
+				throw std::runtime_error("Failed to start test process.");
+
+			if (processId == 0)
+			{
+				close(outputPipe[0]);
+				close(resultPipe[0]);
+				dup2(outputPipe[1], STDOUT_FILENO);
+				close(outputPipe[1]);
+
+				// Process [PROCESS] takes every case of the current shard at [PROCESS] modulo the process count,
+				// which is the same as shard [SHARD] + [PROCESS] * [SHARD_COUNT] of the combined shard count
+				auto combinedShardCount = options.ShardCount * options.ProcessCount;
+				scheduler.SetShard(options.ShardIndex + process * options.ShardCount, combinedShardCount);
+				scheduler.SetCompleted(finishedResults);
+				RunChildProcess(scheduler, resultPipe[1]);
+			}
+
+			// Only the child may hold the write ends, or the reads below would never see the end of the stream
+			close(outputPipe[1]);
+			close(resultPipe[1]);
+			return TestProcess{ process, processId, outputPipe[0], resultPipe[0], std::string(), std::string() };
+		}
+
+		[[noreturn]] static void RunChildProcess(TestScheduler& scheduler, int resultPipe)
+		{
+			auto exitCode = 0;
+			try
+			{
+				// Write the record of every case as soon as it finishes, a process stopped by the watchdog keeps what it already ran.
+				// One record per case, the descriptors are found again by index in the parent
+				// [TABLE] [TEST] [ROW] [IS_PASS] [DURATION_NS] [ALLOCATIONS] [ALLOCATED_BYTES] [PEAK_LIVE_BYTES] [PEAK_RESIDENT_BYTES] [MESSAGE_SIZE]
+				// [MESSAGE]
+				// The watchdog writes the record of a case that timed out from its own thread
+				auto& tables = scheduler.GetTables();
+				auto records = std::string();
+				auto recordsMutex = std::mutex();
+				scheduler.SetResultHandler([&tables, &records, &recordsMutex, resultPipe](std::span<const TestResult> batch)
+				{
+					auto lock = std::lock_guard<std::mutex>(recordsMutex);
+					records.clear();
+					for (auto& testResult : batch)
+					{
+						auto testIndex = static_cast<size_t>(testResult.Test - tables[testResult.TableIndex].Tests.data());
+						records += std::to_string(testResult.TableIndex) + " ";
+						records += std::to_string(testIndex) + " ";
+						records += std::to_string(testResult.Row) + " ";
+						records += testResult.IsPass ? "1 " : "0 ";
+						records += std::to_string(testResult.Duration.count()) + " ";
+						records += std::to_string(testResult.Allocations.Count) + " ";
+						records += std::to_string(testResult.Allocations.Bytes) + " ";
+						records += std::to_string(testResult.Allocations.PeakLiveBytes) + " ";
+						records += std::to_string(testResult.PeakResidentBytes) + " ";
+						records += std::to_string(testResult.Message.size()) + "\n";
+						records += testResult.Message;
+						records += "\n";
+					}
+
+					WriteAll(resultPipe, records);
+				});
+
+				auto results = std::vector<TestResult>();
+				scheduler.Run(results);
+				std::cout.flush();
+			}
+			catch (const std::exception& ex)
+			{
+				std::cout << "ERROR: " << ex.what() << std::endl;
+				exitCode = -1;
+			}
+
+			// Skip the static destructors of the state copied from the parent
+			_exit(exitCode);
+		}
+
+		/// <summary>
+		/// Read the records of a process and return their counts, a record cut off by the end of a stopped process is dropped
+		/// </summary>
+		static TestState ReadResults(
+			const TestScheduler& scheduler,
+			std::istringstream& resultStream,
+			std::vector<TestResult>& results)
+		{
+			auto state = TestState{ 0, 0 };
+			auto& tables = scheduler.GetTables();
+			size_t tableIndex = 0;
+			size_t testIndex = 0;
+			size_t row = 0;
+			int isPass = 0;
+			std::chrono::nanoseconds::rep duration = 0;
+			auto allocations = AllocationStats{ 0, 0, 0 };
+			size_t peakResidentBytes = 0;
+			size_t messageSize = 0;
+			while (resultStream >> tableIndex >> testIndex >> row >> isPass >> duration >>
+				allocations.Count >> allocations.Bytes >> allocations.PeakLiveBytes >> peakResidentBytes >> messageSize)
+			{
+				// Skip the line break before the message
+				resultStream.get();
+				auto message = std::string(messageSize, '\0');
+				resultStream.read(message.data(), static_cast<std::streamsize>(messageSize));
+				if (!resultStream)
+					break;
+
+				if (tableIndex >= tables.size() ||
+					testIndex >= tables[tableIndex].Tests.size() ||
+					row >= std::max<size_t>(tables[tableIndex].Tests[testIndex].RowNames.size(), 1))
+				{
+					throw std::runtime_error("Invalid test process result.");
+				}
+
+				auto& table = tables[tableIndex];
+				auto& test = table.Tests[testIndex];
+				results.push_back(TestResult{
+					tableIndex,
+					&table.Classes[test.ClassIndex],
+					&test,
+					row,
+					isPass != 0,
+					std::chrono::nanoseconds(duration),
+					allocations,
+					peakResidentBytes,
+					std::move(message),
+				});
+
+				if (isPass != 0)
+					state.PassCount++;
+				else
+					state.FailCount++;
+			}
+
+			return state;
+		}
+
+		static void ReadProcessPipes(std::vector<TestProcess>& processes)
+		{
+			// Drain the output and result pipes of every process together so no process blocks on a full pipe,
+			// the poll entries of process [PROCESS] are its output at 2 * [PROCESS] and its results right after
+			auto pollFiles = std::vector<pollfd>();
+			for (auto& testProcess : processes)
+			{
+				pollFiles.push_back(pollfd{ testProcess.OutputPipe, POLLIN, 0 });
+				pollFiles.push_back(pollfd{ testProcess.ResultPipe, POLLIN, 0 });
+			}
+
+			auto openCount = pollFiles.size();
+			char buffer[16 * 1024];
+			while (openCount > 0)
+			{
+				if (poll(pollFiles.data(), pollFiles.size(), -1) < 0)
+				{
+					if (errno == EINTR)
+						continue;
+
+					throw std::runtime_error("Failed to wait for test process output.");
+				}
+
+				for (size_t index = 0; index < pollFiles.size(); index++)
+				{
+					auto& pollFile = pollFiles[index];
+					if (pollFile.fd < 0 || pollFile.revents == 0)
+						continue;
+
+					auto readCount = read(pollFile.fd, buffer, sizeof(buffer));
+					if (readCount > 0)
+					{
+						auto& testProcess = processes[index / 2];
+						auto& content = index % 2 == 0 ? testProcess.Output : testProcess.Result;
+						content.append(buffer, static_cast<size_t>(readCount));
+					}
+					else if (readCount == 0 || errno != EINTR)
+					{
+						close(pollFile.fd);
+						pollFile.fd = -1;
+						openCount--;
+					}
+				}
+			}
+		}
+
+		static void WriteAll(int file, std::string_view content)
+		{
+			while (!content.empty())
+			{
+				auto writeCount = write(file, content.data(), content.size());
+				if (writeCount < 0)
+				{
+					if (errno == EINTR)
+						continue;
+
+					throw std::runtime_error("Failed to write test process result.");
+				}
+
+				content.remove_prefix(static_cast<size_t>(writeCount));
+			}
+		}
+#endif
+	};
+}
@@ -0,0 +1,346 @@
+#pragma once
+
+namespace Soup::Test
+{
+	/// <summary>
+	/// The outcome of a single test case, the descriptors refer into the registered test tables
+	/// </summary>
+	export struct TestResult
+	{
+		size_t TableIndex;
+		const TestClassDescriptor* Class;
+		const TestDescriptor* Test;
+		size_t Row;
+		bool IsPass;
+		std::chrono::nanoseconds Duration;
+		AllocationStats Allocations;
+
+		// The process wide high-water mark once the case completed, only sampled when requested
+		size_t PeakResidentBytes;
+		std::string Message;
+
+		TestCaseName GetName() const
+		{
+			return TestCaseName{ Test->Name, Test->RowNames.empty() ? nullptr : &Test->RowNames[Row] };
+		}
+	};
+
+	/// <summary>
+	/// The machine readable report formats
+	/// </summary>
+	export enum class TestReportFormat
+	{
+		None,
+		JUnit,
+		Json,
+	};
+
+	/// <summary>
+	/// Writes the summaries and reports of a test run from its results
+	/// </summary>
+	export class TestReport
+	{
+	public:
+		/// <summary>
+		/// Write the longest running test cases, slowest first
+		/// </summary>
+		static void WriteSlowest(const std::vector<TestResult>& results, size_t count, std::ostream& output)
+		{
+			auto slowestResults = std::vector<const TestResult*>();
+			for (auto& result : results)
+				slowestResults.push_back(&result);
+
+			auto slowestCount = std::min(count, slowestResults.size());
+			std::partial_sort(
+				slowestResults.begin(),
+				slowestResults.begin() + slowestCount,
+				slowestResults.end(),
+				[](const TestResult* lhs, const TestResult* rhs) { return lhs->Duration > rhs->Duration; });
+			slowestResults.resize(slowestCount);
+			if (slowestResults.empty())
+				return;
+
+			auto content = std::string();
+			content += "Slowest " + std::to_string(slowestResults.size()) + " tests:\n";
+			for (auto result : slowestResults)
+			{
+				content += "\t";
+				WriteMilliseconds(result->Duration, content);
+				content += " ms ";
+				content += result->Class->Name;
+				content += "::";
+				content += result->GetName().ToString();
+				content += "\n";
+			}
+
+			output << content;
+		}
+
+		/// <summary>
+		/// Write the test cases that allocated the most bytes on their own thread, and the largest resident set seen
+		/// </summary>
+		static void WriteMostAllocating(const std::vector<TestResult>& results, size_t count, std::ostream& output)
+		{
+			auto allocatingResults = std::vector<const TestResult*>();
+			const TestResult* peakResidentResult = nullptr;
+			for (auto& result : results)
+			{
+				if (result.Allocations.Bytes > 0)
+					allocatingResults.push_back(&result);
+				if (peakResidentResult == nullptr || result.PeakResidentBytes > peakResidentResult->PeakResidentBytes)
+					peakResidentResult = &result;
+			}
+
+			auto allocatingCount = std::min(count, allocatingResults.size());
+			std::partial_sort(
+				allocatingResults.begin(),
+				allocatingResults.begin() + allocatingCount,
+				allocatingResults.end(),
+				[](const TestResult* lhs, const TestResult* rhs) { return lhs->Allocations.Bytes > rhs->Allocations.Bytes; });
+			allocatingResults.resize(allocatingCount);
+
+			auto content = std::string();
+			if (!allocatingResults.empty())
+			{
+				content += "Most allocating " + std::to_string(allocatingResults.size()) + " tests:\n";
+				for (auto result : allocatingResults)
+				{
+					content += "\t";
+					content += std::to_string(result->Allocations.Bytes) + " bytes in ";
+					content += std::to_string(result->Allocations.Count) + " allocations, peak ";
+					content += std::to_string(result->Allocations.PeakLiveBytes) + " bytes ";
+					content += result->Class->Name;
+					content += "::";
+					content += result->GetName().ToString();
+					content += "\n";
+				}
+			}
+
+			if (peakResidentResult != nullptr && peakResidentResult->PeakResidentBytes > 0)
+			{
+				content += "Peak resident set " + std::to_string(peakResidentResult->PeakResidentBytes) + " bytes, first reached by ";
+				content += peakResidentResult->Class->Name;
+				content += "::";
+				content += peakResidentResult->GetName().ToString();
+				content += "\n";
+			}
+
+			output << content;
+		}
+
+		static void Save(
+			const std::string& file,
+			TestReportFormat format,
+			const TestState& state,
+			std::chrono::nanoseconds duration,
+			const std::vector<TestResult>& results)
+		{
+			auto content = std::string();
+			if (format == TestReportFormat::JUnit)
+				WriteJUnit(state, duration, results, content);
+			else
+				WriteJson(state, duration, results, content);
+
+			auto outputFile = std::ofstream(file, std::ios::binary);
+			outputFile.write(content.data(), content.size());
+			if (!outputFile)
+				throw std::runtime_error("Failed to write test report: " + file);
+		}
+
+	private:
+		static void WriteJUnit(
+			const TestState& state,
+			std::chrono::nanoseconds duration,
+			const std::vector<TestResult>& results,
+			std::string& content)
+		{
+			content += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+			content += "<testsuites tests=\"" + std::to_string(state.FailCount + state.PassCount) + "\"";
+			content += " failures=\"" + std::to_string(state.FailCount) + "\" time=\"";
+			WriteSeconds(duration, content);
+			content += "\">\n";
+
+			// The results are in registration order so the cases of a class are next to each other
+			size_t suiteStart = 0;
+			while (suiteStart < results.size())
+			{
+				auto testClass = results[suiteStart].Class;
+				auto suiteEnd = suiteStart;
+				auto failCount = 0;
+				auto suiteDuration = std::chrono::nanoseconds(0);
+				while (suiteEnd < results.size() && results[suiteEnd].Class == testClass)
+				{
+					failCount += results[suiteEnd].IsPass ? 0 : 1;
+					suiteDuration += results[suiteEnd].Duration;
+					suiteEnd++;
+				}
+
+				content += "\t<testsuite name=\"";
+				WriteXmlString(testClass->Name, content);
+				content += "\" tests=\"" + std::to_string(suiteEnd - suiteStart) + "\"";
+				content += " failures=\"" + std::to_string(failCount) + "\" time=\"";
+				WriteSeconds(suiteDuration, content);
+				content += "\">\n";
+
+				for (auto i = suiteStart; i < suiteEnd; i++)
+				{
+					auto& result = results[i];
+					content += "\t\t<testcase classname=\"";
+					WriteXmlString(testClass->Name, content);
+					content += "\" name=\"";
+					WriteXmlString(result.GetName().ToString(), content);
+					content += "\" time=\"";
+					WriteSeconds(result.Duration, content);
+					if (result.IsPass)
+					{
+						content += "\"/>\n";
+					}
+					else
+					{
+						content += "\">\n\t\t\t<failure message=\"";
+						WriteXmlString(result.Message, content);
+						content += "\"/>\n\t\t</testcase>\n";
+					}
+				}
+
+				content += "\t</testsuite>\n";
+				suiteStart = suiteEnd;
+			}
+
+			content += "</testsuites>\n";
+		}
+
+		static void WriteJson(
+			const TestState& state,
+			std::chrono::nanoseconds duration,
+			const std::vector<TestResult>& results,
+			std::string& content)
+		{
+			content += "{\n";
+			content += "\t\"passed\": " + std::to_string(state.PassCount) + ",\n";
+			content += "\t\"failed\": " + std::to_string(state.FailCount) + ",\n";
+			content += "\t\"durationMs\": ";
+			WriteMilliseconds(duration, content);
+			content += ",\n";
+			content += "\t\"tests\": [";
+			for (size_t i = 0; i < results.size(); i++)
+			{
+				auto& result = results[i];
+				content += i == 0 ? "\n\t\t{ \"class\": " : ",\n\t\t{ \"class\": ";
+				WriteJsonString(result.Class->Name, content);
+				content += ", \"name\": ";
+				WriteJsonString(result.GetName().ToString(), content);
+				content += result.IsPass ? ", \"passed\": true" : ", \"passed\": false";
+				content += ", \"durationMs\": ";
+				WriteMilliseconds(result.Duration, content);
+				content += ", \"allocations\": " + std::to_string(result.Allocations.Count);
+				content += ", \"allocatedBytes\": " + std::to_string(result.Allocations.Bytes);
+				content += ", \"peakLiveBytes\": " + std::to_string(result.Allocations.PeakLiveBytes);
+				if (result.PeakResidentBytes > 0)
+					content += ", \"peakResidentBytes\": " + std::to_string(result.PeakResidentBytes);
+				if (!result.IsPass)
+				{
+					content += ", \"message\": ";
+					WriteJsonString(result.Message, content);
+				}
+
+				content += " }";
+			}
+
+			content += results.empty() ? "]\n" : "\n\t]\n";
+			content += "}\n";
+		}
+
+		static void WriteMilliseconds(std::chrono::nanoseconds duration, std::string& content)
+		{
+			// Microsecond resolution is plenty and keeps the numbers readable
+			WriteFixed(std::chrono::duration_cast<std::chrono::microseconds>(duration).count(), 1000, 3, content);
+		}
+
+		static void WriteSeconds(std::chrono::nanoseconds duration, std::string& content)
+		{
+			WriteFixed(std::chrono::duration_cast<std::chrono::microseconds>(duration).count(), 1000000, 6, content);
+		}
+
+		static void WriteFixed(int64_t value, int64_t scale, size_t fractionDigits, std::string& content)
+		{
+			content += std::to_string(value / scale);
+			content += ".";
+			auto fraction = std::to_string(value % scale);
+			content.append(fractionDigits - fraction.size(), '0');
+			content += fraction;
+		}
+
+		static void WriteXmlString(std::string_view value, std::string& content)
+		{
+			for (char character : value)
+			{
+				switch (character)
+				{
+					case '&':
+						content += "&amp;";
+						break;
+					case '<':
+						content += "&lt;";
+						break;
+					case '>':
+						content += "&gt;";
+						break;
+					case '"':
+						content += "&quot;";
+						break;
+					case '\n':
+						content += "&#10;";
+						break;
+					default:
+						// Other control characters are not allowed in XML 1.0
+						if (static_cast<unsigned char>(character) >= 0x20 || character == '\t')
+							content += character;
+						break;
+				}
+			}
+		}
+
+		static void WriteJsonString(std::string_view value, std::string& content)
+		{
+			content += '"';
+			for (char character : value)
+			{
+				switch (character)
+				{
+					case '"':
+						content += "\\\"";
+						break;
+					case '\\':
+						content += "\\\\";
+						break;
+					case '\n':
+						content += "\\n";
+						break;
+					case '\r':
+						content += "\\r";
+						break;
+					case '\t':
+						content += "\\t";
+						break;
+					default:
+						if (static_cast<unsigned char>(character) < 0x20)
+						{
+							constexpr std::string_view HexDigits = "0123456789abcdef";
+							content += "\\u00";
+							content += HexDigits[(character >> 4) & 0xF];
+							content += HexDigits[character & 0xF];
+						}
+						else
+						{
+							content += character;
+						}
+
+						break;
+				}
+			}
+
+			content += '"';
+		}
+	};
+}
@@ -0,0 +1,237 @@
+#pragma once
+
+namespace Soup::Test
+{
+	/// <summary>
+	/// The capture buffer of the test running on this thread, null when output goes straight through
+	/// </summary>
+	thread_local std::string* CurrentOutputCapture = nullptr;
+
+	/// <summary>
+	/// A stream buffer that appends to the capture of the current thread while a test runs there
+	/// and forwards to the original buffer otherwise
+	/// </summary>
+	class CaptureStreamBuffer : public std::streambuf
+	{
+	public:
+		CaptureStreamBuffer(std::streambuf* target) :
+			m_target(target)
+		{
+		}
+
+	protected:
+		int_type overflow(int_type value) override
+		{
+			if (traits_type::eq_int_type(value, traits_type::eof()))
+				return traits_type::not_eof(value);
+
+			auto character = traits_type::to_char_type(value);
+			return xsputn(&character, 1) == 1 ? value : traits_type::eof();
+		}
+
+		std::streamsize xsputn(const char* data, std::streamsize count) override
+		{
+			auto capture = CurrentOutputCapture;
+			if (capture != nullptr)
+			{
+				capture->append(data, static_cast<size_t>(count));
+				return count;
+			}
+
+			return m_target->sputn(data, count);
+		}
+
+		int sync() override
+		{
+			return CurrentOutputCapture != nullptr ? 0 : m_target->pubsync();
+		}
+
+	private:
+		std::streambuf* m_target;
+	};
+
+	/// <summary>
+	/// Redirects std::cout and std::cerr into the per thread capture for as long as it lives.
+	/// Only the standard streams are captured, printf and direct writes to the file descriptors still go straight out.
+	/// </summary>
+	class OutputCapture
+	{
+	public:
+		OutputCapture() :
+			m_outputBuffer(std::cout.rdbuf()),
+			m_errorBuffer(std::cerr.rdbuf()),
+			m_captureOutputBuffer(m_outputBuffer),
+			m_captureErrorBuffer(m_errorBuffer)
+		{
+			std::cout.flush();
+			std::cout.rdbuf(&m_captureOutputBuffer);
+			std::cerr.rdbuf(&m_captureErrorBuffer);
+		}
+
+		OutputCapture(const OutputCapture&) = delete;
+		OutputCapture& operator=(const OutputCapture&) = delete;
+
+		~OutputCapture()
+		{
+			std::cout.rdbuf(m_outputBuffer);
+			std::cerr.rdbuf(m_errorBuffer);
+		}
+
+	private:
+		std::streambuf* m_outputBuffer;
+		std::streambuf* m_errorBuffer;
+		CaptureStreamBuffer m_captureOutputBuffer;
+		CaptureStreamBuffer m_captureErrorBuffer;
+	};
+
+	/// <summary>
+	/// Collects the finished test cases from every worker and writes the failures from a single writer thread.
+	/// Workers push onto a lock free stack that the writer takes whole and reverses, so a worker never waits on the console
+	/// and the writer flushes once per batch instead of once per line. Each batch is also handed to the optional result handler.
+	/// </summary>
+	class TestReporter
+	{
+	public:
+		TestReporter(std::streambuf& output, std::function<void(std::span<const TestResult>)> resultHandler = nullptr) :
+			m_output(output),
+			m_resultHandler(std::move(resultHandler)),
+			m_head(nullptr),
+			m_signal(0),
+			m_isStopping(false),
+			m_results(),
+			m_writer()
+		{
+			m_writer = std::thread([this]() { RunWriter(); });
+		}
+
+		TestReporter(const TestReporter&) = delete;
+		TestReporter& operator=(const TestReporter&) = delete;
+
+		~TestReporter()
+		{
+			if (m_writer.joinable())
+				Finish();
+		}
+
+		/// <summary>
+		/// Hand over a finished case, the output is only written when the case failed
+		/// </summary>
+		void Submit(TestResult result, std::string output)
+		{
+			auto node = new ResultNode{ nullptr, std::move(result), std::move(output) };
+			node->Next = m_head.load(std::memory_order_relaxed);
+			while (!m_head.compare_exchange_weak(node->Next, node, std::memory_order_release, std::memory_order_relaxed))
+			{
+			}
+
+			Signal();
+		}
+
+		/// <summary>
+		/// Write everything still pending, stop the writer and take the results in the order they were submitted
+		/// </summary>
+		std::vector<TestResult> Finish()
+		{
+			m_isStopping.store(true, std::memory_order_release);
+			Signal();
+			m_writer.join();
+			return std::move(m_results);
+		}
+
+	private:
+		struct ResultNode
+		{
+			ResultNode* Next;
+			TestResult Result;
+			std::string Output;
+		};
+
+		void Signal()
+		{
+			m_signal.fetch_add(1, std::memory_order_release);
+			m_signal.notify_one();
+		}
+
+		void RunWriter()
+		{
+			auto content = std::string();
+			while (true)
+			{
+				// Read the signal before checking for work so a submit in between always wakes the wait
+				auto signal = m_signal.load(std::memory_order_acquire);
+				auto isStopping = m_isStopping.load(std::memory_order_acquire);
+				auto batch = m_head.exchange(nullptr, std::memory_order_acquire);
+				if (batch == nullptr)
+				{
+					if (isStopping)
+						return;
+
+					m_signal.wait(signal, std::memory_order_acquire);
+					continue;
+				}
+
+				// The stack is newest first
+				ResultNode* ordered = nullptr;
+				while (batch != nullptr)
+				{
+					auto next = batch->Next;
+					batch->Next = ordered;
+					ordered = batch;
+					batch = next;
+				}
+
+				content.clear();
+				auto batchStart = m_results.size();
+				while (ordered != nullptr)
+				{
+					auto node = std::unique_ptr<ResultNode>(ordered);
+					ordered = ordered->Next;
+					if (!node->Result.IsPass)
+						WriteFailure(*node, content);
+
+					m_results.push_back(std::move(node->Result));
+				}
+
+				if (!content.empty())
+				{
+					m_output.sputn(content.data(), static_cast<std::streamsize>(content.size()));
+					m_output.pubsync();
+				}
+
+				if (m_resultHandler != nullptr)
+					m_resultHandler(std::span<const TestResult>(m_results).subspan(batchStart));
+			}
+		}
+
+		static void WriteFailure(const ResultNode& node, std::string& content)
+		{
+			auto& result = node.Result;
+			content += "FAIL: ";
+			content += result.Class->Name;
+			content += "::";
+			content += result.GetName().ToString();
+			content += "\n";
+			if (!result.Message.empty())
+			{
+				content += result.Message;
+				content += "\n";
+			}
+
+			if (!node.Output.empty())
+			{
+				content += "Output:\n";
+				content += node.Output;
+				if (node.Output.back() != '\n')
+					content += "\n";
+			}
+		}
+
+		std::streambuf& m_output;
+		std::function<void(std::span<const TestResult>)> m_resultHandler;
+		std::atomic<ResultNode*> m_head;
+		std::atomic<uint32_t> m_signal;
+		std::atomic<bool> m_isStopping;
+		std::vector<TestResult> m_results;
+		std::thread m_writer;
+	};
+}
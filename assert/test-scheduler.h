@@ -0,0 +1,479 @@
+#pragma once
+
+namespace Soup::Test
+{
+	/// <summary>
+	/// Runs the registered test tables on a pool of workers.
+	/// The tasks are built up front in registration order and every worker claims the next one from a shared atomic index.
+	/// A parallel test case is a task on its own, a serialized class is a single task that runs all of its cases,
+	/// and the cases of not thread safe classes run on the calling thread once every worker is done.
+	/// Sampling the resident set runs every case on the calling thread, the high-water mark is reset before each of them.
+	/// A test class is destroyed as soon as its last case finishes, releasing its collection fixtures with it.
+	/// The console output of each case is captured and only written, by the reporter, when the case fails.
+	/// A case with a timeout is watched while it runs and a hung case ends the process, see TestWatchdog.
+	/// A process started again after a timeout leaves out the cases that already have a result.
+	/// </summary>
+	export class TestScheduler
+	{
+	public:
+		/// <summary>
+		/// Zero requests one worker per hardware thread
+		/// </summary>
+		TestScheduler(size_t workerCount) :
+			m_workerCount(workerCount == 0 ? std::max<size_t>(std::thread::hardware_concurrency(), 1) : workerCount),
+			m_shardIndex(0),
+			m_shardCount(1),
+			m_isMemorySampled(false),
+			m_memoryLimitBytes(0),
+			m_resultHandler(),
+			m_timeout(0),
+			m_filter(),
+			m_completedCases(),
+			m_tables()
+		{
+		}
+
+		size_t GetWorkerCount() const
+		{
+			return m_workerCount;
+		}
+
+		/// <summary>
+		/// Register a table, the table and everything it references must outlive the run
+		/// </summary>
+		void Add(const TestTable& table)
+		{
+			m_tables.push_back(table);
+		}
+
+		/// <summary>
+		/// Only run every [COUNT]th test case starting at [INDEX], counted in registration order
+		/// so every process that registers the same tables agrees on the split
+		/// </summary>
+		void SetShard(size_t index, size_t count)
+		{
+			m_shardIndex = index;
+			m_shardCount = count;
+		}
+
+		/// <summary>
+		/// Only run the test cases that pass the filter, the shard split applies to the cases that remain
+		/// </summary>
+		void SetFilter(TestFilter filter)
+		{
+			m_filter = std::move(filter);
+		}
+
+		/// <summary>
+		/// Leave out the cases that already have a result, the shard split still counts them
+		/// so the remaining cases keep their place in it
+		/// </summary>
+		void SetCompleted(std::span<const TestResult> results)
+		{
+			m_completedCases.clear();
+			for (auto& result : results)
+				m_completedCases.push_back(CaseKey(result.TableIndex, result.Test, result.Row));
+
+			std::sort(m_completedCases.begin(), m_completedCases.end());
+		}
+
+		/// <summary>
+		/// Record the resident set high-water mark of every test case, which runs every case one at a time on the calling thread
+		/// </summary>
+		void SetMemorySampling(bool isMemorySampled)
+		{
+			m_isMemorySampled = isMemorySampled;
+		}
+
+		/// <summary>
+		/// Fail every case whose resident set high-water mark is over the limit, zero turns the limit off.
+		/// A limit samples the resident set of every case.
+		/// </summary>
+		void SetMemoryLimit(size_t limitBytes)
+		{
+			m_memoryLimitBytes = limitBytes;
+			m_isMemorySampled = m_isMemorySampled || limitBytes > 0;
+		}
+
+		/// <summary>
+		/// Receive the finished cases while the run goes, in batches on the reporter thread, in the order they finished
+		/// </summary>
+		void SetResultHandler(std::function<void(std::span<const TestResult>)> resultHandler)
+		{
+			m_resultHandler = std::move(resultHandler);
+		}
+
+		/// <summary>
+		/// The timeout of every case that does not set its own, zero only watches the cases that do
+		/// </summary>
+		void SetTimeout(std::chrono::milliseconds timeout)
+		{
+			m_timeout = timeout;
+		}
+
+		/// <summary>
+		/// Write the full name of every selected test case without creating any test class
+		/// </summary>
+		void List(std::ostream& output) const
+		{
+			size_t selectedIndex = 0;
+			for (auto& table : m_tables)
+			{
+				for (size_t classIndex = 0; classIndex < table.Classes.size(); classIndex++)
+				{
+					auto& testClass = table.Classes[classIndex];
+					for (auto& test : table.Tests)
+					{
+						if (test.ClassIndex != classIndex)
+							continue;
+
+						auto rowCount = test.RowNames.empty() ? 1 : test.RowNames.size();
+						for (size_t row = 0; row < rowCount; row++)
+						{
+							if (IsSelected(testClass, test, row, selectedIndex))
+								output << testClass.Name << "::" << GetTestCaseName(test, row) << "\n";
+						}
+					}
+				}
+			}
+		}
+
+		const std::vector<TestTable>& GetTables() const
+		{
+			return m_tables;
+		}
+
+		/// <summary>
+		/// Run every selected test and block until all complete
+		/// </summary>
+		TestState Run() const
+		{
+			auto results = std::vector<TestResult>();
+			return Run(results);
+		}
+
+		/// <summary>
+		/// Run every selected test and record the outcome and duration of each case in registration order
+		/// </summary>
+		TestState Run(std::vector<TestResult>& results) const
+		{
+			// Each test class is created on first use and shared by all of its tests
+			auto classes = std::deque<ClassInstance>();
+			auto cases = std::vector<TestCase>();
+			auto tasks = std::vector<TestTask>();
+			auto exclusiveCases = std::vector<TestCase>();
+			auto isWatched = m_timeout.count() > 0;
+			size_t selectedIndex = 0;
+			for (size_t tableIndex = 0; tableIndex < m_tables.size(); tableIndex++)
+			{
+				auto& table = m_tables[tableIndex];
+				auto firstClass = classes.size();
+				for (auto& testClass : table.Classes)
+					classes.emplace_back(testClass);
+
+				for (size_t classIndex = 0; classIndex < table.Classes.size(); classIndex++)
+				{
+					auto& testClass = table.Classes[classIndex];
+					auto& instance = classes[firstClass + classIndex];
+					// The resident set is a process wide measure, it can only be put on a single case while nothing else runs
+					auto execution = testClass.Execution;
+					auto isExclusive = execution == TestExecution::NotThreadSafe || m_isMemorySampled;
+					auto& target = isExclusive ? exclusiveCases : cases;
+					auto firstCase = target.size();
+					for (auto& test : table.Tests)
+					{
+						if (test.ClassIndex != classIndex)
+							continue;
+
+						auto rowCount = test.RowNames.empty() ? 1 : test.RowNames.size();
+						for (size_t row = 0; row < rowCount; row++)
+						{
+							if (!IsSelected(testClass, test, row, selectedIndex) || IsCompleted(tableIndex, test, row))
+								continue;
+
+							if (!isExclusive && execution == TestExecution::Parallel)
+								tasks.push_back(TestTask{ target.size(), target.size() + 1 });
+
+							target.push_back(TestCase{ tableIndex, &test, row, &instance });
+							isWatched = isWatched || test.TimeoutMilliseconds > 0;
+						}
+					}
+
+					// Only a class with cases to run holds on to its fixtures
+					auto caseCount = target.size() - firstCase;
+					instance.RemainingCaseCount.store(caseCount, std::memory_order_relaxed);
+					if (caseCount > 0)
+						RetainCollectionFixtures(testClass);
+
+					if (!isExclusive && execution == TestExecution::Serialized && caseCount > 0)
+						tasks.push_back(TestTask{ firstCase, target.size() });
+				}
+			}
+
+			// The watchdog thread is only started when some case can time out
+			auto watchdog = isWatched ? std::make_unique<TestWatchdog>(m_workerCount, m_resultHandler) : nullptr;
+
+			// The reporter writes to the real output, which the capture must not redirect
+			auto reporter = TestReporter(*std::cout.rdbuf(), m_resultHandler);
+			auto state = TestState{ 0, 0 };
+			{
+				auto capture = OutputCapture();
+				state += RunTasks(cases, tasks, reporter, watchdog.get());
+
+				// The calling thread is the first worker
+				auto output = std::string();
+				for (auto& testCase : exclusiveCases)
+					state += RunCase(testCase, 0, output, reporter, watchdog.get());
+			}
+
+			watchdog.reset();
+
+			auto reportedResults = reporter.Finish();
+			std::move(reportedResults.begin(), reportedResults.end(), std::back_inserter(results));
+
+			SortResults(results);
+			return state;
+		}
+
+		/// <summary>
+		/// Order the results as the cases were registered
+		/// </summary>
+		static void SortResults(std::vector<TestResult>& results)
+		{
+			std::sort(
+				results.begin(),
+				results.end(),
+				[](const TestResult& lhs, const TestResult& rhs)
+				{
+					return std::tie(lhs.TableIndex, lhs.Test->ClassIndex, lhs.Test, lhs.Row) <
+						std::tie(rhs.TableIndex, rhs.Test->ClassIndex, rhs.Test, rhs.Row);
+				});
+		}
+
+	private:
+		/// <summary>
+		/// The lazily created instance of a single test class, destroyed by the last of its cases to finish
+		/// </summary>
+		struct ClassInstance
+		{
+			ClassInstance(const TestClassDescriptor& descriptor) :
+				Descriptor(descriptor),
+				CreateFlag(),
+				Instance(nullptr),
+				RemainingCaseCount(0)
+			{
+			}
+
+			const TestClassDescriptor& Descriptor;
+			std::once_flag CreateFlag;
+			void* Instance;
+			std::atomic<size_t> RemainingCaseCount;
+		};
+
+		/// <summary>
+		/// A single row of a single test
+		/// </summary>
+		struct TestCase
+		{
+			size_t TableIndex;
+			const TestDescriptor* Test;
+			size_t Row;
+			ClassInstance* Class;
+		};
+
+		/// <summary>
+		/// A single case by its table, test and row
+		/// </summary>
+		using CaseKey = std::tuple<size_t, const TestDescriptor*, size_t>;
+
+		/// <summary>
+		/// A range of cases that run in order on one worker
+		/// </summary>
+		struct TestTask
+		{
+			size_t Begin;
+			size_t End;
+		};
+
+		TestState RunTasks(
+			const std::vector<TestCase>& cases,
+			const std::vector<TestTask>& tasks,
+			TestReporter& reporter,
+			TestWatchdog* watchdog) const
+		{
+			auto workerCount = std::min(m_workerCount, std::max<size_t>(tasks.size(), 1));
+
+			// The task list is fixed up front, so claiming the next index is all the coordination the workers need
+			auto nextTask = std::atomic<size_t>(0);
+
+			// Every worker sums into its own state so the counts are only combined once at the end,
+			// and reuses a single capture buffer for the output of its cases
+			auto states = std::vector<TestState>(workerCount, TestState{ 0, 0 });
+			auto runWorker = [this, &cases, &tasks, &nextTask, &states, &reporter, watchdog](size_t worker)
+			{
+				auto output = std::string();
+				for (auto index = nextTask.fetch_add(1, std::memory_order_relaxed);
+					index < tasks.size();
+					index = nextTask.fetch_add(1, std::memory_order_relaxed))
+				{
+					for (auto i = tasks[index].Begin; i < tasks[index].End; i++)
+						states[worker] += RunCase(cases[i], worker, output, reporter, watchdog);
+				}
+			};
+
+			// The calling thread participates as the first worker
+			auto threads = std::vector<std::thread>();
+			threads.reserve(workerCount - 1);
+			for (size_t worker = 1; worker < workerCount; worker++)
+				threads.emplace_back(runWorker, worker);
+
+			runWorker(0);
+
+			for (auto& thread : threads)
+				thread.join();
+
+			auto state = TestState{ 0, 0 };
+			for (auto& workerState : states)
+				state += workerState;
+
+			return state;
+		}
+
+		bool IsSelected(
+			const TestClassDescriptor& testClass,
+			const TestDescriptor& test,
+			size_t row,
+			size_t& selectedIndex) const
+		{
+			// Benchmarks are left out before counting so they never shift the shard split
+			if (test.IsBenchmark)
+				return false;
+
+			auto rowName = test.RowNames.empty() ? nullptr : &test.RowNames[row];
+			if (!m_filter.IsMatch(testClass.Name, test.Name, rowName))
+				return false;
+
+			return selectedIndex++ % m_shardCount == m_shardIndex;
+		}
+
+		bool IsCompleted(size_t tableIndex, const TestDescriptor& test, size_t row) const
+		{
+			return std::binary_search(m_completedCases.begin(), m_completedCases.end(), CaseKey(tableIndex, &test, row));
+		}
+
+		static TestCaseName GetTestCaseName(const TestDescriptor& test, size_t row)
+		{
+			return TestCaseName{ test.Name, test.RowNames.empty() ? nullptr : &test.RowNames[row] };
+		}
+
+		TestState RunCase(
+			const TestCase& testCase,
+			size_t worker,
+			std::string& output,
+			TestReporter& reporter,
+			TestWatchdog* watchdog) const
+		{
+			auto& test = *testCase.Test;
+			auto& instance = *testCase.Class;
+			auto row = testCase.Row;
+			auto timeout = test.TimeoutMilliseconds > 0 ? std::chrono::milliseconds(test.TimeoutMilliseconds) : m_timeout;
+			auto isWatched = watchdog != nullptr && timeout.count() > 0;
+			auto createClass = [&instance]()
+			{
+				// A failed create leaves the flag unset so the next test of the class tries again
+				std::call_once(instance.CreateFlag, [&instance]() { instance.Instance = instance.Descriptor.Create(); });
+			};
+			auto runTest = [&test, &instance, row]()
+			{
+				test.Invoke(instance.Instance, row);
+			};
+
+			auto failureMessage = std::string();
+			output.clear();
+			CurrentOutputCapture = &output;
+
+			// The first case of a class creates it before the measured region so the time, allocations
+			// and resident set of the case are its own, a failed create fails the case without running it
+			auto isPass = TryRunTestCase(createClass, failureMessage);
+			auto duration = std::chrono::steady_clock::duration::zero();
+			auto allocationStats = AllocationStats{ 0, 0, 0 };
+			size_t peakResidentBytes = 0;
+			if (isPass)
+			{
+				if (m_isMemorySampled)
+					ResetPeakResidentBytes();
+				auto allocations = AllocationScope();
+				if (isWatched)
+					watchdog->Start(worker, testCase.TableIndex, instance.Descriptor, test, row, timeout);
+				auto startTime = std::chrono::steady_clock::now();
+				isPass = TryRunTestCase(runTest, failureMessage);
+				duration = std::chrono::steady_clock::now() - startTime;
+				if (isWatched)
+					watchdog->Stop(worker);
+				allocationStats = allocations.GetStats();
+				peakResidentBytes = m_isMemorySampled ? GetPeakResidentBytes() : 0;
+			}
+
+			CurrentOutputCapture = nullptr;
+			if (isPass && m_memoryLimitBytes > 0 && peakResidentBytes > m_memoryLimitBytes)
+			{
+				isPass = false;
+				failureMessage = "Peak resident set " + std::to_string(peakResidentBytes) +
+					" bytes is over the limit of " + std::to_string(m_memoryLimitBytes) + " bytes";
+			}
+
+			// Only a failure needs its output, a pass keeps the buffer for the next case
+			reporter.Submit(
+				TestResult{
+					testCase.TableIndex,
+					&instance.Descriptor,
+					&test,
+					row,
+					isPass,
+					std::chrono::duration_cast<std::chrono::nanoseconds>(duration),
+					allocationStats,
+					peakResidentBytes,
+					std::move(failureMessage),
+				},
+				isPass ? std::string() : std::move(output));
+
+			// The decrements order every case of the class before the teardown
+			if (instance.RemainingCaseCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				FinishClass(instance);
+
+			return isPass ? TestState{ 0, 1 } : TestState{ 1, 0 };
+		}
+
+		static void FinishClass(ClassInstance& instance)
+		{
+			if (instance.Instance != nullptr)
+			{
+				instance.Descriptor.Destroy(instance.Instance);
+				instance.Instance = nullptr;
+			}
+
+			ReleaseCollectionFixtures(instance.Descriptor);
+		}
+
+		size_t m_workerCount;
+		size_t m_shardIndex;
+		size_t m_shardCount;
+		bool m_isMemorySampled;
+		size_t m_memoryLimitBytes;
+		std::function<void(std::span<const TestResult>)> m_resultHandler;
+		std::chrono::milliseconds m_timeout;
+		TestFilter m_filter;
+		std::vector<CaseKey> m_completedCases;
+		std::vector<TestTable> m_tables;
+	};
+
+	/// <summary>
+	/// Run every test in the table in order on the calling thread
+	/// </summary>
+	export TestState RunTests(const TestTable& table)
+	{
+		auto scheduler = TestScheduler(1);
+		scheduler.Add(table);
+		return scheduler.Run();
+	}
+}
@@ -0,0 +1,238 @@
+#pragma once
+
+namespace Soup::Test
+{
+#ifdef __GLIBC__
+	/// <summary>
+	/// Set by the stuck thread once it has written its own stack
+	/// </summary>
+	std::atomic<bool> IsWatchdogStackDumped = false;
+#endif
+
+	/// <summary>
+	/// Watches the test case running on every worker and ends the run when one of them hangs.
+	/// A case past its timeout is reported as failed together with the stack of the thread running it,
+	/// then the process exits with TimeoutExitCode since there is no safe way to stop the stuck thread.
+	/// The failed result of the case is handed to the result handler before the exit, a forked test process
+	/// sends it to the parent, which starts a new process for the cases that have no result yet.
+	/// In a single process it aborts the whole run.
+	/// The stack is requested from the stuck thread with SIGUSR2, which a test with a timeout must leave alone.
+	/// </summary>
+	class TestWatchdog
+	{
+	public:
+		static constexpr int TimeoutExitCode = 3;
+
+		TestWatchdog(size_t workerCount, std::function<void(std::span<const TestResult>)> resultHandler) :
+			m_workers(workerCount),
+			m_resultHandler(std::move(resultHandler)),
+			m_mutex(),
+			m_wake(),
+			m_isStopping(false),
+			m_thread()
+		{
+			InstallStackDump();
+			m_thread = std::thread([this]() { RunWatchdog(); });
+		}
+
+		TestWatchdog(const TestWatchdog&) = delete;
+		TestWatchdog& operator=(const TestWatchdog&) = delete;
+
+		~TestWatchdog()
+		{
+			{
+				auto lock = std::lock_guard<std::mutex>(m_mutex);
+				m_isStopping = true;
+			}
+
+			m_wake.notify_one();
+			m_thread.join();
+		}
+
+		/// <summary>
+		/// Start the clock on the case the calling thread is about to run as the given worker
+		/// </summary>
+		void Start(
+			size_t worker,
+			size_t tableIndex,
+			const TestClassDescriptor& testClass,
+			const TestDescriptor& test,
+			size_t row,
+			std::chrono::milliseconds timeout)
+		{
+			auto& slot = m_workers[worker];
+			auto lock = std::lock_guard<std::mutex>(slot.Mutex);
+			slot.TableIndex = tableIndex;
+			slot.Class = &testClass;
+			slot.Test = &test;
+			slot.Row = row;
+			slot.Timeout = timeout;
+			slot.Deadline = std::chrono::steady_clock::now() + timeout;
+#ifndef _WIN32
+			slot.Thread = pthread_self();
+#endif
+		}
+
+		void Stop(size_t worker)
+		{
+			auto& slot = m_workers[worker];
+			auto lock = std::lock_guard<std::mutex>(slot.Mutex);
+			slot.Class = nullptr;
+		}
+
+	private:
+		static constexpr auto CheckInterval = std::chrono::milliseconds(50);
+		static constexpr auto StackDumpWait = std::chrono::seconds(2);
+
+		/// <summary>
+		/// The case currently running on a single worker, no class while the worker is between cases
+		/// </summary>
+		struct WorkerSlot
+		{
+			std::mutex Mutex;
+			size_t TableIndex = 0;
+			const TestClassDescriptor* Class = nullptr;
+			const TestDescriptor* Test = nullptr;
+			size_t Row = 0;
+			std::chrono::milliseconds Timeout = std::chrono::milliseconds(0);
+			std::chrono::steady_clock::time_point Deadline;
+#ifndef _WIN32
+			pthread_t Thread;
+#endif
+		};
+
+		void RunWatchdog()
+		{
+			auto lock = std::unique_lock<std::mutex>(m_mutex);
+			while (!m_wake.wait_for(lock, CheckInterval, [this]() { return m_isStopping; }))
+			{
+				auto now = std::chrono::steady_clock::now();
+				for (auto& slot : m_workers)
+				{
+					auto slotLock = std::unique_lock<std::mutex>(slot.Mutex);
+					if (slot.Class != nullptr && now >= slot.Deadline)
+						ReportTimeout(slot);
+				}
+			}
+		}
+
+		/// <summary>
+		/// Write the stuck case and its stack straight to the output file, the streams may be held by the stuck thread
+		/// </summary>
+		[[noreturn]] void ReportTimeout(const WorkerSlot& slot)
+		{
+			auto rowName = slot.Test->RowNames.empty() ? nullptr : &slot.Test->RowNames[slot.Row];
+			auto message = "Timed out after " + std::to_string(slot.Timeout.count()) + " ms";
+			auto report = std::string("FAIL: ");
+			report += slot.Class->Name;
+			report += "::";
+			report += TestCaseName{ slot.Test->Name, rowName }.ToString();
+			report += "\n" + message + "\n";
+			report += "Stack:\n";
+			WriteOutput(report);
+
+			DumpStack(slot);
+
+			// The case never reaches the reporter, its result goes straight to the handler
+			if (m_resultHandler)
+			{
+				auto result = TestResult{
+					slot.TableIndex,
+					slot.Class,
+					slot.Test,
+					slot.Row,
+					false,
+					std::chrono::duration_cast<std::chrono::nanoseconds>(slot.Timeout),
+					AllocationStats{ 0, 0, 0 },
+					0,
+					std::move(message),
+				};
+				m_resultHandler(std::span<const TestResult>(&result, 1));
+			}
+
+			WriteOutput("Stopping the test run, the remaining tests of this process did not run.\n");
+			std::_Exit(TimeoutExitCode);
+		}
+
+#ifdef __GLIBC__
+		static void InstallStackDump()
+		{
+			// The first backtrace loads the unwinder, which must not happen inside the signal handler
+			void* frame = nullptr;
+			backtrace(&frame, 1);
+
+			struct sigaction action = {};
+			action.sa_handler = DumpStackSignalHandler;
+			action.sa_flags = SA_RESTART;
+			sigemptyset(&action.sa_mask);
+			sigaction(SIGUSR2, &action, nullptr);
+		}
+
+		/// <summary>
+		/// Runs on the stuck thread, which is the only thread that can walk its own stack
+		/// </summary>
+		static void DumpStackSignalHandler(int)
+		{
+			void* frames[64];
+			auto frameCount = backtrace(frames, 64);
+			backtrace_symbols_fd(frames, frameCount, STDOUT_FILENO);
+			IsWatchdogStackDumped.store(true, std::memory_order_release);
+		}
+
+		static void DumpStack(const WorkerSlot& slot)
+		{
+			// The handler writes the stack from the stuck thread, give up on a thread that never takes the signal
+			IsWatchdogStackDumped.store(false, std::memory_order_relaxed);
+			if (pthread_kill(slot.Thread, SIGUSR2) == 0)
+			{
+				auto endTime = std::chrono::steady_clock::now() + StackDumpWait;
+				while (!IsWatchdogStackDumped.load(std::memory_order_acquire))
+				{
+					if (std::chrono::steady_clock::now() >= endTime)
+						break;
+
+					std::this_thread::sleep_for(std::chrono::milliseconds(10));
+				}
+			}
+
+			if (!IsWatchdogStackDumped.load(std::memory_order_acquire))
+				WriteOutput("The stack of the test thread is not available.\n");
+		}
+#else
+		static void InstallStackDump()
+		{
+		}
+
+		static void DumpStack(const WorkerSlot&)
+		{
+			WriteOutput("The stack of the test thread is not available on this platform.\n");
+		}
+#endif
+
+		static void WriteOutput(std::string_view content)
+		{
+#ifdef _WIN32
+			std::fwrite(content.data(), 1, content.size(), stdout);
+			std::fflush(stdout);
+#else
+			while (!content.empty())
+			{
+				auto writeCount = write(STDOUT_FILENO, content.data(), content.size());
+				if (writeCount < 0 && errno == EINTR)
+					continue;
+				if (writeCount <= 0)
+					return;
+
+				content.remove_prefix(static_cast<size_t>(writeCount));
+			}
+#endif
+		}
+
+		std::vector<WorkerSlot> m_workers;
+		std::function<void(std::span<const TestResult>)> m_resultHandler;
+		std::mutex m_mutex;
+		std::condition_variable m_wake;
+		bool m_isStopping;
+		std::thread m_thread;
+	};
+}
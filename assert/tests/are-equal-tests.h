@@ -0,0 +1,211 @@
+#pragma once
+
+namespace Soup::Test::UnitTests
+{
+	/// <summary>
+	/// The range overloads of Assert::AreEqual, a failure must name the first mismatch and the elements around it
+	/// </summary>
+	class AreEqualTests
+	{
+	public:
+		void Vector_Match()
+		{
+			auto values = std::vector<int>({ 1, 2, 3, 4 });
+			Assert::AreEqual(values, std::vector<int>({ 1, 2, 3, 4 }), "Verify the vectors match");
+		}
+
+		void Vector_Mismatch_ReportsWindow()
+		{
+			auto expected = std::vector<int>();
+			for (int i = 0; i < 20; i++)
+				expected.push_back(i);
+			auto actual = expected;
+			actual[10] = 99;
+
+			auto message = GetFailure([&]() { Assert::AreEqual(expected, actual, "Values"); });
+			Assert::AreEqual(
+				std::string_view("Assert Failed: Values Mismatch at index 10 of 20 "
+					"Expected<... 6, 7, 8, 9, 10, 11, 12, 13, 14 ...> "
+					"Actual<... 6, 7, 8, 9, 99, 11, 12, 13, 14 ...>"),
+				std::string_view(message),
+				"Verify the failure message");
+		}
+
+		void Vector_Mismatch_AtStart()
+		{
+			auto message = GetFailure([]()
+			{
+				Assert::AreEqual(std::vector<int>({ 1, 2, 3 }), std::vector<int>({ 0, 2, 3 }), "Values");
+			});
+			Assert::AreEqual(
+				std::string_view("Assert Failed: Values Mismatch at index 0 of 3 Expected<1, 2, 3> Actual<0, 2, 3>"),
+				std::string_view(message),
+				"Verify the failure message");
+		}
+
+		void Vector_SizeMismatch()
+		{
+			auto message = GetFailure([]()
+			{
+				Assert::AreEqual(std::vector<int>({ 1, 2, 3 }), std::vector<int>({ 1, 2 }), "Values");
+			});
+			Assert::AreEqual(
+				std::string_view("Assert Failed: Values Size does not match [3, 2]"),
+				std::string_view(message),
+				"Verify the failure message");
+		}
+
+		void VectorOfBool()
+		{
+			auto values = std::vector<bool>({ true, false, true });
+			Assert::AreEqual(values, std::vector<bool>({ true, false, true }), "Verify the vectors match");
+
+			auto message = GetFailure([&]()
+			{
+				Assert::AreEqual(values, std::vector<bool>({ true, true, true }), "Flags");
+			});
+			Assert::AreEqual(std::string_view("Assert Failed: Flags"), std::string_view(message), "Verify the failure message");
+		}
+
+		void Vector_Mismatch_InLaterBlock()
+		{
+			// Past the first memcmp block so the narrowing search is exercised
+			auto expected = std::vector<uint8_t>(1000, 7);
+			auto actual = expected;
+			actual[700] = 8;
+
+			auto message = GetFailure([&]() { Assert::AreEqual(expected, actual, "Bytes"); });
+			Assert::IsTrue(
+				message.starts_with("Assert Failed: Bytes Mismatch at index 700 of 1000 "),
+				"Verify the mismatch index");
+		}
+
+		void Array_Match()
+		{
+			auto values = std::array<int, 3>({ 1, 2, 3 });
+			Assert::AreEqual(values, std::array<int, 3>({ 1, 2, 3 }), "Verify the arrays match");
+
+			auto message = GetFailure([&]()
+			{
+				Assert::AreEqual(values, std::array<int, 3>({ 1, 2, 4 }), "Values");
+			});
+			Assert::AreEqual(
+				std::string_view("Assert Failed: Values Mismatch at index 2 of 3 Expected<1, 2, 3> Actual<1, 2, 4>"),
+				std::string_view(message),
+				"Verify the failure message");
+		}
+
+		void Span_Match()
+		{
+			int expected[] = { 5, 6, 7 };
+			int actual[] = { 5, 6, 7 };
+			Assert::AreEqual(std::span<const int>(expected), std::span<const int>(actual), "Verify the spans match");
+
+			actual[1] = 0;
+			auto message = GetFailure([&]()
+			{
+				Assert::AreEqual(std::span<const int>(expected), std::span<const int>(actual), "Values");
+			});
+			Assert::AreEqual(
+				std::string_view("Assert Failed: Values Mismatch at index 1 of 3 Expected<5, 6, 7> Actual<5, 0, 7>"),
+				std::string_view(message),
+				"Verify the failure message");
+		}
+
+		void ContiguousRange_ArrayAgainstVector()
+		{
+			auto expected = std::array<int, 3>({ 1, 2, 3 });
+			Assert::AreEqual(expected, std::vector<int>({ 1, 2, 3 }), "Verify the ranges match");
+
+			auto message = GetFailure([&]()
+			{
+				Assert::AreEqual(expected, std::vector<int>({ 1, 2, 3, 4 }), "Values");
+			});
+			Assert::AreEqual(
+				std::string_view("Assert Failed: Values Size does not match [3, 4]"),
+				std::string_view(message),
+				"Verify the failure message");
+		}
+
+		void Float_WithinUlps()
+		{
+			auto expected = std::vector<float>({ 1.0f, -2.0f, 0.0f });
+			auto actual = std::vector<float>({
+				std::nextafter(1.0f, 2.0f),
+				std::nextafter(-2.0f, -3.0f),
+				-0.0f,
+			});
+			Assert::AreEqual(expected, actual, FloatTolerance{ 0, 1 }, "Verify one ulp apart is equal");
+
+			actual[0] = std::nextafter(actual[0], 2.0f);
+			auto message = GetFailure([&]()
+			{
+				Assert::AreEqual(expected, actual, FloatTolerance{ 0, 1 }, "Values");
+			});
+			Assert::IsTrue(
+				message.starts_with("Assert Failed: Values Mismatch at index 0 of 3 outside tolerance (absolute 0, ulps 1)"),
+				"Verify the failure names the tolerance");
+		}
+
+		void Double_WithinAbsolute()
+		{
+			auto expected = std::array<double, 2>({ 10.0, 20.0 });
+			auto actual = std::array<double, 2>({ 10.05, 19.95 });
+			Assert::AreEqual(expected, actual, FloatTolerance{ 0.1, 0 }, "Verify the difference is within the bound");
+
+			auto message = GetFailure([&]()
+			{
+				Assert::AreEqual(expected, actual, FloatTolerance{ 0.01, 0 }, "Values");
+			});
+			Assert::IsTrue(
+				message.starts_with("Assert Failed: Values Mismatch at index 0 of 2 outside tolerance"),
+				"Verify the first pair fails");
+		}
+
+		void Float_NaNNeverEqual()
+		{
+			auto values = std::vector<double>({ 1.0, std::numeric_limits<double>::quiet_NaN() });
+			auto message = GetFailure([&]()
+			{
+				Assert::AreEqual(values, values, FloatTolerance{ 1, 1000 }, "Values");
+			});
+			Assert::IsTrue(
+				message.starts_with("Assert Failed: Values Mismatch at index 1 of 2"),
+				"Verify NaN does not match itself");
+		}
+
+	private:
+		template<typename TFunc>
+		static std::string GetFailure(TFunc test)
+		{
+			auto exception = Assert::Throws<std::logic_error>(std::move(test));
+			return exception.what();
+		}
+	};
+}
+
+SoupTest::TestTable GetAreEqualTestsTests()
+{
+	using Soup::Test::UnitTests::AreEqualTests;
+	static constexpr SoupTest::TestClassDescriptor testClasses[] =
+	{
+		{ "Soup::Test::UnitTests::AreEqualTests", SoupTest::CreateTestClass<AreEqualTests>, SoupTest::DestroyTestClass<AreEqualTests>, SoupTest::TestClassExecution<AreEqualTests>, SoupTest::TestClassCollectionFixtures<AreEqualTests> },
+	};
+	static constexpr SoupTest::TestDescriptor tests[] =
+	{
+		{ "Vector_Match", 0, [](void* testClass, size_t) { static_cast<AreEqualTests*>(testClass)->Vector_Match(); }, {} },
+		{ "Vector_Mismatch_ReportsWindow", 0, [](void* testClass, size_t) { static_cast<AreEqualTests*>(testClass)->Vector_Mismatch_ReportsWindow(); }, {} },
+		{ "Vector_Mismatch_AtStart", 0, [](void* testClass, size_t) { static_cast<AreEqualTests*>(testClass)->Vector_Mismatch_AtStart(); }, {} },
+		{ "Vector_SizeMismatch", 0, [](void* testClass, size_t) { static_cast<AreEqualTests*>(testClass)->Vector_SizeMismatch(); }, {} },
+		{ "VectorOfBool", 0, [](void* testClass, size_t) { static_cast<AreEqualTests*>(testClass)->VectorOfBool(); }, {} },
+		{ "Vector_Mismatch_InLaterBlock", 0, [](void* testClass, size_t) { static_cast<AreEqualTests*>(testClass)->Vector_Mismatch_InLaterBlock(); }, {} },
+		{ "Array_Match", 0, [](void* testClass, size_t) { static_cast<AreEqualTests*>(testClass)->Array_Match(); }, {} },
+		{ "Span_Match", 0, [](void* testClass, size_t) { static_cast<AreEqualTests*>(testClass)->Span_Match(); }, {} },
+		{ "ContiguousRange_ArrayAgainstVector", 0, [](void* testClass, size_t) { static_cast<AreEqualTests*>(testClass)->ContiguousRange_ArrayAgainstVector(); }, {} },
+		{ "Float_WithinUlps", 0, [](void* testClass, size_t) { static_cast<AreEqualTests*>(testClass)->Float_WithinUlps(); }, {} },
+		{ "Double_WithinAbsolute", 0, [](void* testClass, size_t) { static_cast<AreEqualTests*>(testClass)->Double_WithinAbsolute(); }, {} },
+		{ "Float_NaNNeverEqual", 0, [](void* testClass, size_t) { static_cast<AreEqualTests*>(testClass)->Float_NaNNeverEqual(); }, {} },
+	};
+
+	return { testClasses, tests };
+}
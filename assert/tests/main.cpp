@@ -0,0 +1,84 @@
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+import Soup.Test.Assert;
+
+namespace SoupTest = Soup::Test;
+
+#include "are-equal-tests.h"
+
+namespace Soup::Test::UnitTests
+{
+	/// <summary>
+	/// Enough small cases that the result records of every test process are far larger than a pipe buffer,
+	/// the run only completes when the parent drains the result pipes while the processes are still writing
+	/// </summary>
+	class ProcessResultTests
+	{
+	public:
+		void Adds()
+		{
+			Assert::AreEqual(4, 2 + 2, "Verify the sum");
+		}
+
+		void Concatenates()
+		{
+			Assert::AreEqual(std::string("ab"), std::string("a") + "b", "Verify the concatenation");
+		}
+
+		void Compares(size_t row)
+		{
+			Assert::IsTrue(row < RowCount, "Verify the row is in range");
+		}
+
+		static constexpr size_t RowCount = 16;
+	};
+}
+
+SoupTest::TestTable GetProcessResultTestsTests()
+{
+	using Soup::Test::UnitTests::ProcessResultTests;
+	static constexpr SoupTest::TestClassDescriptor testClasses[] =
+	{
+		{ "Soup::Test::UnitTests::ProcessResultTests", SoupTest::CreateTestClass<ProcessResultTests>, SoupTest::DestroyTestClass<ProcessResultTests>, SoupTest::TestClassExecution<ProcessResultTests>, SoupTest::TestClassCollectionFixtures<ProcessResultTests> },
+	};
+	static constexpr SoupTest::TheoryRowName CompareRowNames[ProcessResultTests::RowCount] = {};
+	static constexpr SoupTest::TestDescriptor tests[] =
+	{
+		{ "Adds", 0, [](void* testClass, size_t) { static_cast<ProcessResultTests*>(testClass)->Adds(); }, {} },
+		{ "Concatenates", 0, [](void* testClass, size_t) { static_cast<ProcessResultTests*>(testClass)->Concatenates(); }, {} },
+		{ "Compares", 0, [](void* testClass, size_t row) { static_cast<ProcessResultTests*>(testClass)->Compares(row); }, CompareRowNames },
+	};
+
+	return { testClasses, tests };
+}
+
+// 18 cases per table, about 20 thousand in total
+static constexpr size_t TableCount = 1200;
+
+void AddAllTests(Soup::Test::TestScheduler& scheduler)
+{
+	scheduler.Add(GetAreEqualTestsTests());
+	for (size_t table = 0; table < TableCount; table++)
+		scheduler.Add(GetProcessResultTestsTests());
+}
+
+int main(int argc, char** argv)
+{
+	// Always fork, the records must cross the result pipes, later arguments still override the process count
+	auto processes = std::string("--processes=4");
+	auto args = std::vector<char*>();
+	args.push_back(argv[0]);
+	args.push_back(processes.data());
+	for (int i = 1; i < argc; i++)
+		args.push_back(argv[i]);
+
+	return Soup::Test::TestHarness::Run(static_cast<int>(args.size()), args.data(), AddAllTests);
+}
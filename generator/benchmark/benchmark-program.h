@@ -0,0 +1,267 @@
+﻿// <copyright file="benchmark-program.h" company="Soup">
+// Copyright (c) Soup. All rights reserved.
+// </copyright>
+
+#pragma once
+#include "synthetic-corpus.h"
+
+namespace Soup::Test::Benchmark
+{
+	/// <summary>
+	/// Runs the generator over a synthetic corpus and reports how it scales
+	/// </summary>
+	class BenchmarkProgram
+	{
+	public:
+		static int Main(std::vector<std::string> args)
+		{
+			try
+			{
+				auto options = BenchmarkOptions();
+				ParseArguments(args, options);
+				Run(options);
+
+				return 0;
+			}
+			catch (const std::exception& ex)
+			{
+				std::cout << "ERROR: " << ex.what() << std::endl;
+				return -1;
+			}
+		}
+
+	private:
+		struct BenchmarkOptions
+		{
+			SyntheticCorpusOptions Corpus;
+			size_t Iterations = 3;
+			size_t WorkerCount = 1;
+			std::filesystem::path WorkDirectory = std::filesystem::temp_directory_path() / "soup-test-generator-benchmark";
+		};
+
+		/// <summary>
+		/// A single verify setting measured on the clean runs
+		/// </summary>
+		struct VerifyRun
+		{
+			std::string_view Name;
+			VerifyLevel Level;
+			uint32_t SamplePercent;
+		};
+
+		static void ParseArguments(const std::vector<std::string>& args, BenchmarkOptions& options)
+		{
+			for (size_t i = 1; i < args.size(); i++)
+			{
+				auto& argument = args[i];
+				if (argument == "-j")
+				{
+					if (i + 1 >= args.size())
+						throw std::runtime_error("Missing worker count for -j.");
+					options.WorkerCount = ParseUnsigned(args[++i], "worker count");
+				}
+				else if (argument.starts_with("-j"))
+				{
+					options.WorkerCount = ParseUnsigned(argument.substr(2), "worker count");
+				}
+				else if (argument.starts_with("--files="))
+				{
+					options.Corpus.FileCount = ParseUnsigned(argument.substr(8), "file count");
+				}
+				else if (argument.starts_with("--helper-files="))
+				{
+					options.Corpus.HelperFileCount = ParseUnsigned(argument.substr(15), "helper file count");
+				}
+				else if (argument.starts_with("--module-files="))
+				{
+					options.Corpus.ModuleFileCount = ParseUnsigned(argument.substr(15), "module file count");
+				}
+				else if (argument.starts_with("--classes="))
+				{
+					options.Corpus.ClassCount = ParseUnsigned(argument.substr(10), "class count");
+				}
+				else if (argument.starts_with("--facts="))
+				{
+					options.Corpus.FactCount = ParseUnsigned(argument.substr(8), "fact count");
+				}
+				else if (argument.starts_with("--theories="))
+				{
+					options.Corpus.TheoryCount = ParseUnsigned(argument.substr(11), "theory count");
+				}
+				else if (argument.starts_with("--inline-data="))
+				{
+					options.Corpus.InlineDataCount = ParseUnsigned(argument.substr(14), "inline data count");
+				}
+				else if (argument.starts_with("--namespace-depth="))
+				{
+					options.Corpus.NamespaceDepth = ParseUnsigned(argument.substr(18), "namespace depth");
+				}
+				else if (argument.starts_with("--iterations="))
+				{
+					options.Iterations = std::max<size_t>(ParseUnsigned(argument.substr(13), "iteration count"), 1);
+				}
+				else if (argument.starts_with("--work-dir="))
+				{
+					options.WorkDirectory = argument.substr(11);
+				}
+				else
+				{
+					throw std::runtime_error("Unknown argument: " + argument);
+				}
+			}
+
+			if (options.WorkerCount == 0)
+				options.WorkerCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+		}
+
+		static size_t ParseUnsigned(const std::string& value, std::string_view name)
+		{
+			size_t parsedLength = 0;
+			unsigned long result = 0;
+			try
+			{
+				result = std::stoul(value, &parsedLength);
+			}
+			catch (const std::exception&)
+			{
+				parsedLength = 0;
+			}
+
+			if (parsedLength == 0 || parsedLength != value.size())
+				throw std::runtime_error("Invalid " + std::string(name) + ": " + value);
+
+			return result;
+		}
+
+		static void Run(const BenchmarkOptions& options)
+		{
+			auto corpusDirectory = options.WorkDirectory / "corpus";
+			auto testCount = SyntheticCorpus::Create(corpusDirectory, options.Corpus);
+			std::cout << "Corpus: " << options.Corpus.FileCount << " test files, " <<
+				options.Corpus.ModuleFileCount << " module files, " <<
+				options.Corpus.HelperFileCount << " helper files, " <<
+				(options.Corpus.FileCount + options.Corpus.ModuleFileCount) * options.Corpus.ClassCount << " classes, " <<
+				testCount << " tests, namespace depth " << options.Corpus.NamespaceDepth << std::endl;
+			std::cout << "Workers: " << options.WorkerCount << ", Iterations: " << options.Iterations << std::endl;
+			std::cout << std::endl;
+
+			auto generatorOptions = GeneratorOptions();
+			generatorOptions.Directories = { corpusDirectory };
+			generatorOptions.WorkerCount = options.WorkerCount;
+			generatorOptions.Verbosity = LogVerbosity::Quiet;
+
+			// Every level is measured from a clean output folder so the manifest cannot skip any work
+			std::cout << "Clean Runs (best of " << options.Iterations << ")" << std::endl;
+			WriteSummaryHeader();
+			auto levels = std::array<VerifyRun, 4>({
+				VerifyRun{ "verify=off", VerifyLevel::Off, 100 },
+				VerifyRun{ "verify=hash", VerifyLevel::Hash, 100 },
+				VerifyRun{ "verify=sample=10%", VerifyLevel::Sample, 10 },
+				VerifyRun{ "verify=full", VerifyLevel::Full, 100 },
+			});
+			auto fullStatistics = GeneratorStatistics();
+			for (auto& level : levels)
+			{
+				generatorOptions.Verify = level.Level;
+				generatorOptions.VerifySamplePercent = level.SamplePercent;
+				auto statistics = RunBest(generatorOptions, options.Iterations, true);
+				WriteSummary(level.Name, statistics);
+				if (level.Level == VerifyLevel::Full)
+					fullStatistics = statistics;
+			}
+
+			// Leave the output of the last clean run in place to measure the up to date check
+			auto upToDateStatistics = RunBest(generatorOptions, options.Iterations, false);
+			WriteSummary("up-to-date", upToDateStatistics);
+			std::cout << std::endl;
+
+			std::cout << "Phase Breakdown (verify=full, summed over workers)" << std::endl;
+			WritePhaseBreakdown(fullStatistics);
+			std::cout << std::endl;
+
+			std::cout << "Peak RSS: " << GetPeakResidentSetSize() / 1024 << " KB" << std::endl;
+		}
+
+		static GeneratorStatistics RunBest(const GeneratorOptions& generatorOptions, size_t iterations, bool isClean)
+		{
+			auto best = GeneratorStatistics();
+			for (size_t iteration = 0; iteration < iterations; iteration++)
+			{
+				if (isClean)
+					std::filesystem::remove_all(generatorOptions.Directories.front() / "gen");
+
+				auto statistics = Program::Generate(generatorOptions);
+
+				if (iteration == 0 || statistics.TotalDuration < best.TotalDuration)
+					best = statistics;
+			}
+
+			return best;
+		}
+
+		static void WriteSummaryHeader()
+		{
+			std::cout << std::left << std::setw(20) << "Run" << std::right <<
+				std::setw(12) << "Total ms" <<
+				std::setw(14) << "Files/s" <<
+				std::setw(14) << "Tests/s" << std::endl;
+		}
+
+		static void WriteSummary(std::string_view name, const GeneratorStatistics& statistics)
+		{
+			auto seconds = std::chrono::duration<double>(statistics.TotalDuration).count();
+			auto testCount = statistics.TestCount;
+			std::cout << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(1) <<
+				std::setw(12) << seconds * 1000.0 <<
+				std::setw(14) << GetRate(statistics.FileCount, seconds) <<
+				std::setw(14) << GetRate(testCount, seconds) << std::endl;
+		}
+
+		static void WritePhaseBreakdown(const GeneratorStatistics& statistics)
+		{
+			auto total = std::chrono::nanoseconds();
+			for (auto& duration : statistics.PhaseDurations)
+			{
+				total += duration;
+			}
+
+			for (size_t i = 0; i < GeneratorStatistics::PhaseCount; i++)
+			{
+				auto phase = static_cast<GeneratorPhase>(i);
+				auto duration = statistics.GetPhaseDuration(phase);
+				auto percent = total.count() > 0 ? 100.0 * duration.count() / total.count() : 0.0;
+				std::cout << "  " << std::left << std::setw(12) << GeneratorStatistics::GetPhaseName(phase) <<
+					std::right << std::fixed << std::setprecision(2) <<
+					std::setw(12) << std::chrono::duration<double, std::milli>(duration).count() << " ms" <<
+					std::setw(8) << std::setprecision(1) << percent << " %" << std::endl;
+			}
+		}
+
+		static double GetRate(size_t count, double seconds)
+		{
+			return seconds > 0 ? count / seconds : 0.0;
+		}
+
+		static size_t GetPeakResidentSetSize()
+		{
+#ifdef _WIN32
+			auto memoryCounters = PROCESS_MEMORY_COUNTERS();
+			if (!GetProcessMemoryInfo(GetCurrentProcess(), &memoryCounters, sizeof(memoryCounters)))
+				return 0;
+
+			return memoryCounters.PeakWorkingSetSize;
+#else
+			struct rusage usage;
+			if (getrusage(RUSAGE_SELF, &usage) != 0)
+				return 0;
+
+#ifdef __APPLE__
+			return static_cast<size_t>(usage.ru_maxrss);
+#else
+			// Linux reports the maximum resident set size in kilobytes
+			return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+		}
+	};
+}
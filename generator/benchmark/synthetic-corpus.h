@@ -0,0 +1,201 @@
+﻿// <copyright file="synthetic-corpus.h" company="Soup">
+// Copyright (c) Soup. All rights reserved.
+// </copyright>
+
+#pragma once
+
+namespace Soup::Test::Benchmark
+{
+	/// <summary>
+	/// The shape of a generated test tree
+	/// </summary>
+	struct SyntheticCorpusOptions
+	{
+		size_t FileCount = 100;
+		size_t HelperFileCount = 0;
+		size_t ModuleFileCount = 0;
+		size_t ClassCount = 2;
+		size_t FactCount = 10;
+		size_t TheoryCount = 4;
+		size_t InlineDataCount = 8;
+		size_t NamespaceDepth = 4;
+	};
+
+	/// <summary>
+	/// Writes synthetic test headers that exercise every part of the generator
+	/// </summary>
+	class SyntheticCorpus
+	{
+	public:
+		/// <summary>
+		/// Replace the contents of the directory with a fresh corpus and return the number of tests it holds
+		/// </summary>
+		static size_t Create(const std::filesystem::path& directory, const SyntheticCorpusOptions& options)
+		{
+			std::filesystem::remove_all(directory);
+			std::filesystem::create_directories(directory);
+
+			// Spread the headers over a few folders so the gen tree mirrors a real project
+			for (size_t fileIndex = 0; fileIndex < options.FileCount; fileIndex++)
+			{
+				auto content = std::string();
+				BuildTestFile(fileIndex, options, content);
+				WriteFile(GetFolder(directory, fileIndex) / ("test-file-" + std::to_string(fileIndex) + ".h"), content);
+			}
+
+			for (size_t fileIndex = 0; fileIndex < options.ModuleFileCount; fileIndex++)
+			{
+				auto content = std::string();
+				BuildModuleFile(fileIndex, options, content);
+				WriteFile(GetFolder(directory, fileIndex) / ("test-module-" + std::to_string(fileIndex) + ".cppm"), content);
+			}
+
+			for (size_t fileIndex = 0; fileIndex < options.HelperFileCount; fileIndex++)
+			{
+				auto content = std::string();
+				BuildHelperFile(fileIndex, options, content);
+				WriteFile(GetFolder(directory, fileIndex) / ("helper-file-" + std::to_string(fileIndex) + ".h"), content);
+			}
+
+			auto testsPerClass = options.FactCount + options.TheoryCount * options.InlineDataCount;
+			return (options.FileCount + options.ModuleFileCount) * options.ClassCount * testsPerClass;
+		}
+
+	private:
+		static constexpr size_t FilesPerFolder = 16;
+		static constexpr std::array<size_t, 3> NamespaceNamesPerBlock = { SIZE_MAX, 1, 2 };
+
+		static std::filesystem::path GetFolder(const std::filesystem::path& directory, size_t fileIndex)
+		{
+			return directory / ("folder-" + std::to_string(fileIndex / FilesPerFolder));
+		}
+
+		static void BuildTestFile(size_t fileIndex, const SyntheticCorpusOptions& options, std::string& content)
+		{
+			content += "#pragma once\n\n";
+			auto blockCount = BuildNamespaceOpen(fileIndex, options, content);
+			BuildTestClasses("File" + std::to_string(fileIndex), options, content);
+			BuildNamespaceClose(blockCount, content);
+		}
+
+		static void BuildModuleFile(size_t fileIndex, const SyntheticCorpusOptions& options, std::string& content)
+		{
+			// The runner imports the module, so the test classes are exported with their namespace
+			content += "module;\n\n";
+			content += "#include <string_view>\n\n";
+			content += "export module Benchmark.Module" + std::to_string(fileIndex) + ";\n\n";
+			content += "export ";
+			auto blockCount = BuildNamespaceOpen(fileIndex, options, content);
+			BuildTestClasses("Module" + std::to_string(fileIndex), options, content);
+			BuildNamespaceClose(blockCount, content);
+		}
+
+		static void BuildTestClasses(const std::string& classPrefix, const SyntheticCorpusOptions& options, std::string& content)
+		{
+			for (size_t classIndex = 0; classIndex < options.ClassCount; classIndex++)
+			{
+				if (classIndex > 0)
+					content += "\n";
+
+				content += "\tclass " + classPrefix + "Class" + std::to_string(classIndex) + "Tests\n";
+				content += "\t{\n";
+				content += "\tpublic:\n";
+
+				for (size_t factIndex = 0; factIndex < options.FactCount; factIndex++)
+				{
+					auto index = std::to_string(factIndex);
+					content += "\t\t[[Fact]]\n";
+					content += "\t\tvoid Fact" + index + "()\n";
+					content += "\t\t{\n";
+					content += "\t\t\tAssert::AreEqual(" + index + ", " + index + ", \"Verify the values match\");\n";
+					content += "\t\t}\n\n";
+				}
+
+				for (size_t theoryIndex = 0; theoryIndex < options.TheoryCount; theoryIndex++)
+				{
+					content += "\t\t[[Theory]]\n";
+					for (size_t inlineDataIndex = 0; inlineDataIndex < options.InlineDataCount; inlineDataIndex++)
+					{
+						auto index = std::to_string(inlineDataIndex);
+						content += "\t\t[[InlineData(" + index + ", \"Row" + index + "\")]]\n";
+					}
+
+					content += "\t\tvoid Theory" + std::to_string(theoryIndex) + "(int value, std::string_view name)\n";
+					content += "\t\t{\n";
+					content += "\t\t\tAssert::IsTrue(value >= 0, \"Verify the value is not negative\");\n";
+					content += "\t\t}\n\n";
+				}
+
+				content += "\tprivate:\n";
+				content += "\t\tint m_value = 0;\n";
+				content += "\t};\n";
+			}
+		}
+
+		static void BuildHelperFile(size_t fileIndex, const SyntheticCorpusOptions& options, std::string& content)
+		{
+			// Attributes that are not tests must still make it past the pre-scan unparsed
+			content += "#pragma once\n\n";
+			auto blockCount = BuildNamespaceOpen(fileIndex, options, content);
+			content += "\tclass Helper" + std::to_string(fileIndex) + "\n";
+			content += "\t{\n";
+			content += "\tpublic:\n";
+			content += "\t\t[[nodiscard]] int GetValue() const\n";
+			content += "\t\t{\n";
+			content += "\t\t\treturn m_values[0];\n";
+			content += "\t\t}\n\n";
+			content += "\tprivate:\n";
+			content += "\t\tint m_values[4] = {};\n";
+			content += "\t};\n";
+			BuildNamespaceClose(blockCount, content);
+		}
+
+		/// <summary>
+		/// Open the namespace of a file and return the number of blocks to close.
+		/// The files rotate between a single qualified namespace, one nested block per name and a mix of both,
+		/// so the generator has to gather the qualifiers of a class from every enclosing block.
+		/// </summary>
+		static size_t BuildNamespaceOpen(size_t fileIndex, const SyntheticCorpusOptions& options, std::string& content)
+		{
+			auto namesPerBlock = NamespaceNamesPerBlock[fileIndex % NamespaceNamesPerBlock.size()];
+			auto nameCount = options.NamespaceDepth + 1;
+			size_t blockCount = 0;
+			for (size_t name = 0; name < nameCount; name++)
+			{
+				if (name % namesPerBlock == 0)
+				{
+					content += blockCount == 0 ? "namespace " : "\nnamespace ";
+					blockCount++;
+				}
+				else
+				{
+					content += "::";
+				}
+
+				content += name == 0 ? "Benchmark" : "Level" + std::to_string(name - 1);
+				if (name + 1 == nameCount || (name + 1) % namesPerBlock == 0)
+					content += "\n{";
+			}
+
+			content += "\n";
+			return blockCount;
+		}
+
+		static void BuildNamespaceClose(size_t blockCount, std::string& content)
+		{
+			for (size_t block = 0; block < blockCount; block++)
+			{
+				content += "}\n";
+			}
+		}
+
+		static void WriteFile(const std::filesystem::path& file, std::string_view content)
+		{
+			std::filesystem::create_directories(file.parent_path());
+			auto outputFile = std::ofstream(file, std::ios::binary);
+			outputFile.write(content.data(), content.size());
+			if (!outputFile)
+				throw std::runtime_error("Failed to write file: " + file.string());
+		}
+	};
+}
@@ -0,0 +1,240 @@
+﻿// <copyright file="file-watcher.h" company="Soup">
+// Copyright (c) Soup. All rights reserved.
+// </copyright>
+
+#pragma once
+
+namespace Soup::Test
+{
+	/// <summary>
+	/// The kind of change observed for a single path
+	/// </summary>
+	enum class FileChangeType
+	{
+		// The file was written or moved into place
+		Changed,
+
+		// The file was deleted or moved away
+		Removed,
+
+		// A directory appeared, or events were lost, and everything under it must be listed again
+		DirectoryCreated,
+
+		// A directory was deleted or moved away along with everything under it
+		DirectoryRemoved,
+	};
+
+	struct FileChange
+	{
+		std::filesystem::path Path;
+		FileChangeType Type;
+	};
+
+	/// <summary>
+	/// Recursively watches directory trees for changes through inotify
+	/// </summary>
+	class FileWatcher
+	{
+	public:
+		FileWatcher()
+		{
+#ifdef __linux__
+			m_fileDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+			if (m_fileDescriptor < 0)
+				throw std::runtime_error("Failed to initialize inotify.");
+#else
+			throw std::runtime_error("Watch mode is only supported on Linux.");
+#endif
+		}
+
+		FileWatcher(const FileWatcher&) = delete;
+		FileWatcher& operator=(const FileWatcher&) = delete;
+
+		~FileWatcher()
+		{
+#ifdef __linux__
+			close(m_fileDescriptor);
+#endif
+		}
+
+		/// <summary>
+		/// Watch the directory and everything below it, except for the excluded directory
+		/// </summary>
+		void AddDirectory(const std::filesystem::path& directory, const std::filesystem::path& excludedDirectory)
+		{
+#ifdef __linux__
+			m_rootDirectories.push_back(directory);
+			m_excludedDirectories.push_back(excludedDirectory);
+			AddWatchTree(directory);
+#endif
+		}
+
+		/// <summary>
+		/// Block until something changes and then keep collecting until the changes settle,
+		/// so an editor save that touches several files results in a single batch
+		/// </summary>
+		std::vector<FileChange> WaitForChanges(std::chrono::milliseconds settleTime)
+		{
+			auto changes = std::map<std::filesystem::path, FileChangeType>();
+#ifdef __linux__
+			while (changes.empty())
+				ReadEvents(-1, changes);
+
+			while (ReadEvents(static_cast<int>(settleTime.count()), changes))
+			{
+			}
+#endif
+
+			auto result = std::vector<FileChange>();
+			for (auto& [path, type] : changes)
+			{
+				result.push_back(FileChange{ path, type });
+			}
+
+			return result;
+		}
+
+	private:
+#ifdef __linux__
+		static constexpr uint32_t WatchMask =
+			IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+
+		void AddWatchTree(const std::filesystem::path& directory)
+		{
+			auto watchDescriptor = inotify_add_watch(m_fileDescriptor, directory.c_str(), WatchMask);
+			if (watchDescriptor < 0)
+				throw std::runtime_error("Failed to watch directory: " + directory.string());
+
+			m_watches.insert_or_assign(watchDescriptor, directory);
+
+			// The tree may change while it is walked, anything missed here is reported by the new watch
+			auto error = std::error_code();
+			for (auto& child : std::filesystem::directory_iterator(directory, error))
+			{
+				if (child.is_directory(error) && !IsExcluded(child.path()))
+					AddWatchTree(child.path());
+			}
+		}
+
+		/// <summary>
+		/// Stop watching a directory that moved away, its watches would keep reporting under the old path.
+		/// A deleted directory is already gone and only has its stale entries dropped.
+		/// </summary>
+		void RemoveWatchTree(const std::filesystem::path& directory)
+		{
+			for (auto watch = m_watches.begin(); watch != m_watches.end();)
+			{
+				auto relativePath = watch->second.lexically_relative(directory);
+				if (!relativePath.empty() && *relativePath.begin() != "..")
+				{
+					inotify_rm_watch(m_fileDescriptor, watch->first);
+					watch = m_watches.erase(watch);
+				}
+				else
+				{
+					watch++;
+				}
+			}
+		}
+
+		bool IsExcluded(const std::filesystem::path& directory) const
+		{
+			return std::find(m_excludedDirectories.begin(), m_excludedDirectories.end(), directory) !=
+				m_excludedDirectories.end();
+		}
+
+		/// <summary>
+		/// Wait up to the timeout for events and drain all that are available, returns false on timeout
+		/// </summary>
+		bool ReadEvents(int timeout, std::map<std::filesystem::path, FileChangeType>& changes)
+		{
+			auto pollDescriptor = pollfd{ m_fileDescriptor, POLLIN, 0 };
+			auto pollResult = poll(&pollDescriptor, 1, timeout);
+			if (pollResult < 0)
+			{
+				if (errno == EINTR)
+					return false;
+
+				throw std::runtime_error("Failed to wait for file changes.");
+			}
+			else if (pollResult == 0)
+			{
+				return false;
+			}
+
+			alignas(inotify_event) char buffer[16 * 1024];
+			while (true)
+			{
+				auto length = read(m_fileDescriptor, buffer, sizeof(buffer));
+				if (length <= 0)
+					break;
+
+				for (auto current = buffer; current < buffer + length;)
+				{
+					auto& event = *reinterpret_cast<const inotify_event*>(current);
+					current += sizeof(inotify_event) + event.len;
+					HandleEvent(event, changes);
+				}
+			}
+
+			return true;
+		}
+
+		void HandleEvent(const inotify_event& event, std::map<std::filesystem::path, FileChangeType>& changes)
+		{
+			if (event.mask & IN_Q_OVERFLOW)
+			{
+				// Events were dropped, fall back to listing every root again
+				for (auto& rootDirectory : m_rootDirectories)
+				{
+					changes.insert_or_assign(rootDirectory, FileChangeType::DirectoryCreated);
+				}
+
+				return;
+			}
+
+			auto watch = m_watches.find(event.wd);
+			if (watch == m_watches.end())
+				return;
+
+			if (event.mask & IN_IGNORED)
+			{
+				// The directory itself is gone
+				m_watches.erase(watch);
+				return;
+			}
+
+			if (event.len == 0)
+				return;
+
+			auto path = watch->second / event.name;
+			if (event.mask & IN_ISDIR)
+			{
+				if ((event.mask & (IN_CREATE | IN_MOVED_TO)) && !IsExcluded(path))
+				{
+					AddWatchTree(path);
+					changes.insert_or_assign(std::move(path), FileChangeType::DirectoryCreated);
+				}
+				else if ((event.mask & (IN_DELETE | IN_MOVED_FROM)) && !IsExcluded(path))
+				{
+					RemoveWatchTree(path);
+					changes.insert_or_assign(std::move(path), FileChangeType::DirectoryRemoved);
+				}
+			}
+			else if (event.mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+			{
+				changes.insert_or_assign(std::move(path), FileChangeType::Changed);
+			}
+			else if (event.mask & (IN_DELETE | IN_MOVED_FROM))
+			{
+				changes.insert_or_assign(std::move(path), FileChangeType::Removed);
+			}
+		}
+
+		int m_fileDescriptor;
+		std::unordered_map<int, std::filesystem::path> m_watches;
+		std::vector<std::filesystem::path> m_rootDirectories;
+		std::vector<std::filesystem::path> m_excludedDirectories;
+#endif
+	};
+}
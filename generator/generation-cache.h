@@ -0,0 +1,166 @@
+﻿// <copyright file="generation-cache.h" company="Soup">
+// Copyright (c) Soup. All rights reserved.
+// </copyright>
+
+#pragma once
+
+namespace Soup::Test
+{
+	/// <summary>
+	/// The cached generation state for a single test header
+	/// </summary>
+	struct GenerationCacheEntry
+	{
+		uint64_t ContentHash;
+		uint64_t FileSize;
+		int64_t LastWriteTime;
+		uint64_t TestCount;
+		std::string ModuleName;
+		std::vector<std::string> TestClasses;
+	};
+
+	/// <summary>
+	/// The persistent manifest that lets the generator skip headers that have not changed
+	/// since the last run with the same generator version and output settings
+	/// </summary>
+	class GenerationCache
+	{
+	public:
+		static constexpr std::string_view FileName = "generator-manifest.txt";
+
+		/// <summary>
+		/// Load the manifest, an unreadable file, a different generator version or different settings produce an empty cache
+		/// </summary>
+		static GenerationCache Load(
+			const std::filesystem::path& file,
+			std::string_view version,
+			std::string_view settings)
+		{
+			auto result = GenerationCache();
+			auto manifest = std::ifstream(file);
+			if (!manifest)
+				return result;
+
+			std::string line;
+			if (!std::getline(manifest, line) || line != FileHeader)
+				return result;
+			if (!std::getline(manifest, line) || line != "Version " + std::string(version))
+				return result;
+			if (!std::getline(manifest, line) || line != "Settings " + std::string(settings))
+				return result;
+
+			GenerationCacheEntry* currentEntry = nullptr;
+			while (std::getline(manifest, line))
+			{
+				if (line.starts_with("File "))
+				{
+					// File <ContentHash> <FileSize> <LastWriteTime> <TestCount> <Key>
+					auto lineStream = std::istringstream(line.substr(5));
+					auto entry = GenerationCacheEntry();
+					lineStream >> std::hex >> entry.ContentHash >> std::dec >> entry.FileSize >> entry.LastWriteTime >> entry.TestCount;
+					lineStream.get();
+
+					std::string key;
+					std::getline(lineStream, key);
+					if (!lineStream || key.empty())
+						return GenerationCache();
+
+					currentEntry = &result.m_entries.insert_or_assign(std::move(key), std::move(entry)).first->second;
+				}
+				else if (line.starts_with("Module ") && currentEntry != nullptr)
+				{
+					currentEntry->ModuleName = line.substr(7);
+				}
+				else if (line.starts_with("Class ") && currentEntry != nullptr)
+				{
+					currentEntry->TestClasses.push_back(line.substr(6));
+				}
+				else if (!line.empty())
+				{
+					// Unknown content, start over rather than trust a partial manifest
+					return GenerationCache();
+				}
+			}
+
+			return result;
+		}
+
+		/// <summary>
+		/// Write the manifest in a stable key order
+		/// </summary>
+		void Save(
+			const std::filesystem::path& file,
+			std::string_view version,
+			std::string_view settings) const
+		{
+			std::filesystem::create_directories(file.parent_path());
+
+			auto manifest = std::ofstream(file);
+			manifest << FileHeader << "\n";
+			manifest << "Version " << version << "\n";
+			manifest << "Settings " << settings << "\n";
+			for (auto& [key, entry] : m_entries)
+			{
+				manifest << "File " << std::hex << entry.ContentHash << std::dec << " " <<
+					entry.FileSize << " " << entry.LastWriteTime << " " << entry.TestCount << " " << key << "\n";
+				if (!entry.ModuleName.empty())
+				{
+					manifest << "Module " << entry.ModuleName << "\n";
+				}
+
+				for (auto& testClass : entry.TestClasses)
+				{
+					manifest << "Class " << testClass << "\n";
+				}
+			}
+
+			if (!manifest)
+				throw std::runtime_error("Failed to write generator manifest.");
+		}
+
+		const GenerationCacheEntry* TryGet(const std::string& key) const
+		{
+			auto entry = m_entries.find(key);
+			if (entry == m_entries.end())
+				return nullptr;
+
+			return &entry->second;
+		}
+
+		void Set(std::string key, GenerationCacheEntry entry)
+		{
+			m_entries.insert_or_assign(std::move(key), std::move(entry));
+		}
+
+		void Remove(const std::string& key)
+		{
+			m_entries.erase(key);
+		}
+
+		const std::map<std::string, GenerationCacheEntry>& GetEntries() const
+		{
+			return m_entries;
+		}
+
+		static constexpr uint64_t InitialHash = 14695981039346656037ull;
+
+		/// <summary>
+		/// FNV-1a hash of the file content, pass in the previous result to continue a hash over multiple blocks
+		/// </summary>
+		static uint64_t HashContent(std::string_view content, uint64_t hash = InitialHash)
+		{
+			for (char value : content)
+			{
+				hash ^= static_cast<unsigned char>(value);
+				hash *= 1099511628211ull;
+			}
+
+			return hash;
+		}
+
+	private:
+		static constexpr std::string_view FileHeader = "SoupTestGeneratorManifest 3";
+
+		std::map<std::string, GenerationCacheEntry> m_entries;
+	};
+}
@@ -0,0 +1,73 @@
+﻿// <copyright file="generator-options.h" company="Soup">
+// Copyright (c) Soup. All rights reserved.
+// </copyright>
+
+#pragma once
+
+namespace Soup::Test
+{
+	/// <summary>
+	/// How thoroughly to check that the parsed syntax tree round trips back to the source text
+	/// </summary>
+	enum class VerifyLevel
+	{
+		// Trust the parser
+		Off,
+
+		// Compare a streaming hash of the serialized tree against the hash of the source
+		Hash,
+
+		// Compare the serialized tree against the source byte for byte
+		Full,
+
+		// Fully verify a stable subset of the files
+		Sample,
+	};
+
+	/// <summary>
+	/// The backend used to produce the test runner text
+	/// </summary>
+	enum class RunnerEmitter
+	{
+		// Write the runner text directly into the output buffer
+		Text,
+
+		// Build the runner syntax tree through the SyntaxFactory and serialize it
+		Syntax,
+
+		// Run both backends and fail if their output differs
+		Compare,
+	};
+
+	/// <summary>
+	/// How much the generator writes to the console
+	/// </summary>
+	enum class LogVerbosity
+	{
+		// Only failures
+		Quiet,
+
+		// Failures and the run summary
+		Normal,
+
+		// Every directory and file as it is processed
+		Detailed,
+	};
+
+	/// <summary>
+	/// The settings for a single generator run
+	/// </summary>
+	struct GeneratorOptions
+	{
+		std::vector<std::filesystem::path> Directories;
+		bool Watch = false;
+		size_t WorkerCount = 1;
+		size_t ShardCount = 0;
+		VerifyLevel Verify = VerifyLevel::Full;
+		uint32_t VerifySamplePercent = 100;
+		RunnerEmitter Emitter = RunnerEmitter::Text;
+		LogVerbosity Verbosity = LogVerbosity::Normal;
+		std::filesystem::path StatisticsFile;
+		size_t StatisticsSlowestCount = 10;
+	};
+}
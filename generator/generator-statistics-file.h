@@ -0,0 +1,170 @@
+﻿// <copyright file="generator-statistics-file.h" company="Soup">
+// Copyright (c) Soup. All rights reserved.
+// </copyright>
+
+#pragma once
+
+namespace Soup::Test
+{
+	/// <summary>
+	/// Writes the statistics of a generator run as a JSON document
+	/// </summary>
+	class GeneratorStatisticsFile
+	{
+	public:
+		static void Save(
+			const std::filesystem::path& file,
+			std::string_view version,
+			const GeneratorOptions& options,
+			const GeneratorStatistics& totals,
+			const std::vector<FileStatistics>& files)
+		{
+			// Order the files by the time spent on each, slowest first
+			auto slowestFiles = std::vector<const FileStatistics*>();
+			for (auto& fileStatistics : files)
+			{
+				slowestFiles.push_back(&fileStatistics);
+			}
+
+			auto slowestCount = std::min(options.StatisticsSlowestCount, slowestFiles.size());
+			std::partial_sort(
+				slowestFiles.begin(),
+				slowestFiles.begin() + slowestCount,
+				slowestFiles.end(),
+				[](const FileStatistics* lhs, const FileStatistics* rhs)
+				{
+					return lhs->Statistics.TotalDuration > rhs->Statistics.TotalDuration;
+				});
+			slowestFiles.resize(slowestCount);
+
+			auto content = std::string();
+			content += "{\n";
+			content += "\t\"version\": ";
+			WriteString(version, content);
+			content += ",\n";
+			content += "\t\"workerCount\": " + std::to_string(options.WorkerCount) + ",\n";
+			content += "\t\"totals\": ";
+			WriteStatistics(totals, 1, content);
+			content += ",\n";
+
+			content += "\t\"slowestFiles\": [";
+			for (size_t i = 0; i < slowestFiles.size(); i++)
+			{
+				content += i == 0 ? "\n" : ",\n";
+				content += "\t\t{ \"file\": ";
+				WriteString(slowestFiles[i]->File, content);
+				content += ", \"durationMs\": ";
+				WriteMilliseconds(slowestFiles[i]->Statistics.TotalDuration, content);
+				content += " }";
+			}
+
+			content += slowestFiles.empty() ? "],\n" : "\n\t],\n";
+
+			content += "\t\"files\": [";
+			for (size_t i = 0; i < files.size(); i++)
+			{
+				content += i == 0 ? "\n\t\t{\n\t\t\t\"file\": " : ",\n\t\t{\n\t\t\t\"file\": ";
+				WriteString(files[i].File, content);
+				content += ",\n\t\t\t\"statistics\": ";
+				WriteStatistics(files[i].Statistics, 3, content);
+				content += "\n\t\t}";
+			}
+
+			content += files.empty() ? "]\n" : "\n\t]\n";
+			content += "}\n";
+
+			if (file.has_parent_path())
+				std::filesystem::create_directories(file.parent_path());
+
+			auto outputFile = std::ofstream(file, std::ios::binary);
+			outputFile.write(content.data(), content.size());
+			if (!outputFile)
+				throw std::runtime_error("Failed to write statistics file: " + file.string());
+		}
+
+	private:
+		static void WriteStatistics(const GeneratorStatistics& statistics, size_t depth, std::string& content)
+		{
+			auto indent = std::string(depth + 1, '\t');
+			content += "{\n";
+			content += indent + "\"files\": " + std::to_string(statistics.FileCount) + ",\n";
+			content += indent + "\"upToDate\": " + std::to_string(statistics.UpToDateCount) + ",\n";
+			content += indent + "\"preScanRejected\": " + std::to_string(statistics.PreScanRejectedCount) + ",\n";
+			content += indent + "\"parsed\": " + std::to_string(statistics.ParsedCount) + ",\n";
+			content += indent + "\"generated\": " + std::to_string(statistics.GeneratedCount) + ",\n";
+			content += indent + "\"testClasses\": " + std::to_string(statistics.TestClassCount) + ",\n";
+			content += indent + "\"testMethods\": " + std::to_string(statistics.TestMethodCount) + ",\n";
+			content += indent + "\"tests\": " + std::to_string(statistics.TestCount) + ",\n";
+			content += indent + "\"bytesRead\": " + std::to_string(statistics.BytesRead) + ",\n";
+			content += indent + "\"bytesWritten\": " + std::to_string(statistics.BytesWritten) + ",\n";
+			content += indent + "\"durationMs\": ";
+			WriteMilliseconds(statistics.TotalDuration, content);
+			content += ",\n";
+			content += indent + "\"phasesMs\": {";
+			for (size_t i = 0; i < GeneratorStatistics::PhaseCount; i++)
+			{
+				auto phase = static_cast<GeneratorPhase>(i);
+				content += i == 0 ? " " : ", ";
+				WriteString(GeneratorStatistics::GetPhaseName(phase), content);
+				content += ": ";
+				WriteMilliseconds(statistics.GetPhaseDuration(phase), content);
+			}
+
+			content += " }\n";
+			content += std::string(depth, '\t') + "}";
+		}
+
+		static void WriteMilliseconds(std::chrono::nanoseconds duration, std::string& content)
+		{
+			// Microsecond resolution is plenty and keeps the numbers readable
+			auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+			content += std::to_string(microseconds / 1000);
+			content += ".";
+			auto fraction = std::to_string(microseconds % 1000);
+			content.append(3 - fraction.size(), '0');
+			content += fraction;
+		}
+
+		static void WriteString(std::string_view value, std::string& content)
+		{
+			content += '"';
+			for (char character : value)
+			{
+				switch (character)
+				{
+					case '"':
+						content += "\\\"";
+						break;
+					case '\\':
+						content += "\\\\";
+						break;
+					case '\n':
+						content += "\\n";
+						break;
+					case '\r':
+						content += "\\r";
+						break;
+					case '\t':
+						content += "\\t";
+						break;
+					default:
+						if (static_cast<unsigned char>(character) < 0x20)
+						{
+							constexpr std::string_view HexDigits = "0123456789abcdef";
+							content += "\\u00";
+							content += HexDigits[(character >> 4) & 0xF];
+							content += HexDigits[character & 0xF];
+						}
+						else
+						{
+							content += character;
+						}
+
+						break;
+				}
+			}
+
+			content += '"';
+		}
+	};
+}
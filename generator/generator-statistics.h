@@ -0,0 +1,130 @@
+﻿// <copyright file="generator-statistics.h" company="Soup">
+// Copyright (c) Soup. All rights reserved.
+// </copyright>
+
+#pragma once
+
+namespace Soup::Test
+{
+	/// <summary>
+	/// The distinct stages a header passes through on its way to a test runner
+	/// </summary>
+	enum class GeneratorPhase
+	{
+		// Walk the directory tree
+		List,
+
+		// Map and hash the header
+		Read,
+
+		// Reject headers that cannot contain tests
+		PreScan,
+
+		// Build the syntax tree
+		Parse,
+
+		// Check the syntax tree round trips to the source
+		Verify,
+
+		// Walk the syntax tree for test classes
+		Collect,
+
+		// Produce the runner text
+		Emit,
+
+		// Compare against and update the runner on disk
+		Write,
+	};
+
+	/// <summary>
+	/// The counters and phase timings for a generator run, the phase durations are summed over all workers
+	/// </summary>
+	struct GeneratorStatistics
+	{
+		static constexpr size_t PhaseCount = static_cast<size_t>(GeneratorPhase::Write) + 1;
+
+		size_t FileCount = 0;
+		size_t UpToDateCount = 0;
+		size_t PreScanRejectedCount = 0;
+		size_t ParsedCount = 0;
+		size_t GeneratedCount = 0;
+		size_t TestClassCount = 0;
+		size_t TestMethodCount = 0;
+		size_t TestCount = 0;
+		uint64_t BytesRead = 0;
+		uint64_t BytesWritten = 0;
+		std::array<std::chrono::nanoseconds, PhaseCount> PhaseDurations = {};
+		std::chrono::nanoseconds TotalDuration = {};
+
+		static std::string_view GetPhaseName(GeneratorPhase phase)
+		{
+			switch (phase)
+			{
+				case GeneratorPhase::List:
+					return "List";
+				case GeneratorPhase::Read:
+					return "Read";
+				case GeneratorPhase::PreScan:
+					return "PreScan";
+				case GeneratorPhase::Parse:
+					return "Parse";
+				case GeneratorPhase::Verify:
+					return "Verify";
+				case GeneratorPhase::Collect:
+					return "Collect";
+				case GeneratorPhase::Emit:
+					return "Emit";
+				case GeneratorPhase::Write:
+					return "Write";
+				default:
+					throw std::runtime_error("Unknown generator phase.");
+			}
+		}
+
+		std::chrono::nanoseconds GetPhaseDuration(GeneratorPhase phase) const
+		{
+			return PhaseDurations[static_cast<size_t>(phase)];
+		}
+
+		/// <summary>
+		/// Charge the time since the phase start to the phase and start the next phase
+		/// </summary>
+		void EndPhase(GeneratorPhase phase, std::chrono::steady_clock::time_point& phaseStart)
+		{
+			auto phaseEnd = std::chrono::steady_clock::now();
+			PhaseDurations[static_cast<size_t>(phase)] +=
+				std::chrono::duration_cast<std::chrono::nanoseconds>(phaseEnd - phaseStart);
+			phaseStart = phaseEnd;
+		}
+
+		GeneratorStatistics& operator+=(const GeneratorStatistics& rhs)
+		{
+			FileCount += rhs.FileCount;
+			UpToDateCount += rhs.UpToDateCount;
+			PreScanRejectedCount += rhs.PreScanRejectedCount;
+			ParsedCount += rhs.ParsedCount;
+			GeneratedCount += rhs.GeneratedCount;
+			TestClassCount += rhs.TestClassCount;
+			TestMethodCount += rhs.TestMethodCount;
+			TestCount += rhs.TestCount;
+			BytesRead += rhs.BytesRead;
+			BytesWritten += rhs.BytesWritten;
+			for (size_t i = 0; i < PhaseCount; i++)
+			{
+				PhaseDurations[i] += rhs.PhaseDurations[i];
+			}
+
+			TotalDuration += rhs.TotalDuration;
+			return *this;
+		}
+	};
+
+	/// <summary>
+	/// The statistics for a single header keyed by its include path
+	/// </summary>
+	struct FileStatistics
+	{
+		std::string File;
+		GeneratorStatistics Statistics;
+	};
+}
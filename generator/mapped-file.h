@@ -0,0 +1,129 @@
+﻿// <copyright file="mapped-file.h" company="Soup">
+// Copyright (c) Soup. All rights reserved.
+// </copyright>
+
+#pragma once
+
+namespace Soup::Test
+{
+	/// <summary>
+	/// A read only memory mapped view of an entire file
+	/// </summary>
+	class MappedFile
+	{
+	public:
+		MappedFile(const std::filesystem::path& file) :
+			m_data(nullptr),
+			m_size(0)
+		{
+#ifdef _WIN32
+			auto fileHandle = CreateFileW(
+				file.c_str(),
+				GENERIC_READ,
+				FILE_SHARE_READ,
+				nullptr,
+				OPEN_EXISTING,
+				FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+				nullptr);
+			if (fileHandle == INVALID_HANDLE_VALUE)
+				throw std::runtime_error("Failed to open file: " + file.string());
+
+			LARGE_INTEGER fileSize;
+			if (!GetFileSizeEx(fileHandle, &fileSize))
+			{
+				CloseHandle(fileHandle);
+				throw std::runtime_error("Failed to read file size: " + file.string());
+			}
+
+			m_size = static_cast<size_t>(fileSize.QuadPart);
+			if (m_size > 0)
+			{
+				auto mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				if (mappingHandle != nullptr)
+				{
+					m_data = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+					CloseHandle(mappingHandle);
+				}
+			}
+
+			CloseHandle(fileHandle);
+#else
+			auto fileDescriptor = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+			if (fileDescriptor < 0)
+				throw std::runtime_error("Failed to open file: " + file.string());
+
+			struct stat fileStatus;
+			if (fstat(fileDescriptor, &fileStatus) != 0)
+			{
+				close(fileDescriptor);
+				throw std::runtime_error("Failed to read file size: " + file.string());
+			}
+
+			m_size = static_cast<size_t>(fileStatus.st_size);
+			if (m_size > 0)
+			{
+				auto data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+				if (data != MAP_FAILED)
+				{
+					// The whole file is consumed front to back
+					madvise(data, m_size, MADV_SEQUENTIAL);
+					m_data = static_cast<const char*>(data);
+				}
+			}
+
+			close(fileDescriptor);
+#endif
+
+			if (m_size > 0 && m_data == nullptr)
+				throw std::runtime_error("Failed to map file: " + file.string());
+		}
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		MappedFile(MappedFile&& other) noexcept :
+			m_data(std::exchange(other.m_data, nullptr)),
+			m_size(std::exchange(other.m_size, 0))
+		{
+		}
+
+		MappedFile& operator=(MappedFile&& other) noexcept
+		{
+			if (this != &other)
+			{
+				Unmap();
+				m_data = std::exchange(other.m_data, nullptr);
+				m_size = std::exchange(other.m_size, 0);
+			}
+
+			return *this;
+		}
+
+		~MappedFile()
+		{
+			Unmap();
+		}
+
+		std::string_view GetContent() const
+		{
+			return std::string_view(m_data, m_size);
+		}
+
+	private:
+		void Unmap()
+		{
+			if (m_data != nullptr)
+			{
+#ifdef _WIN32
+				UnmapViewOfFile(m_data);
+#else
+				munmap(const_cast<char*>(m_data), m_size);
+#endif
+				m_data = nullptr;
+			}
+		}
+
+		const char* m_data;
+		size_t m_size;
+	};
+}
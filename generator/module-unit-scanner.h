@@ -0,0 +1,206 @@
+﻿// <copyright file="module-unit-scanner.h" company="Soup">
+// Copyright (c) Soup. All rights reserved.
+// </copyright>
+
+#pragma once
+
+namespace Soup::Test
+{
+	/// <summary>
+	/// A lightweight token scan over a C++20 module unit that finds the name of the module it declares
+	/// and blanks out the module syntax so the rest of the unit can be parsed as a regular header.
+	/// Every masked character is replaced by a space, so line breaks and offsets are kept intact.
+	/// </summary>
+	class ModuleUnitScanner
+	{
+	public:
+		/// <summary>
+		/// Check that the source is a primary module interface unit and produce its parsable text,
+		/// partitions and implementation units cannot be imported on their own so they are rejected
+		/// </summary>
+		static bool TryScanInterface(std::string_view source, std::string& moduleName, std::string& parseSource)
+		{
+			moduleName.clear();
+			parseSource.assign(source.data(), source.size());
+
+			auto isInterface = false;
+			auto isLineStart = true;
+			auto isDeclarationStart = true;
+			auto exportStart = std::string_view::npos;
+			auto exportBlocks = std::vector<bool>();
+			size_t offset = 0;
+			while (offset < source.size())
+			{
+				auto value = source[offset];
+				if (value == '\n')
+				{
+					isLineStart = true;
+					offset++;
+				}
+				else if (value == ' ' || value == '\t' || value == '\r' || value == '\f' || value == '\v')
+				{
+					offset++;
+				}
+				else if (source.substr(offset, 2) == "//")
+				{
+					offset = SkipLine(source, offset, false);
+				}
+				else if (source.substr(offset, 2) == "/*")
+				{
+					auto commentEnd = source.find("*/", offset + 2);
+					offset = commentEnd == std::string_view::npos ? source.size() : commentEnd + 2;
+				}
+				else if (value == '#' && isLineStart)
+				{
+					offset = SkipLine(source, offset, true);
+				}
+				else if (value == '\"' || value == '\'')
+				{
+					offset = SkipLiteral(source, offset);
+					isLineStart = false;
+					isDeclarationStart = false;
+				}
+				else if (IsIdentifierCharacter(value))
+				{
+					auto identifierStart = offset;
+					while (offset < source.size() && IsIdentifierCharacter(source[offset]))
+						offset++;
+
+					auto identifier = source.substr(identifierStart, offset - identifierStart);
+					if (IsRawLiteralPrefix(identifier) && offset < source.size() && source[offset] == '\"')
+					{
+						offset = SkipRawLiteral(source, offset);
+						isDeclarationStart = false;
+					}
+					else if (identifier == "export")
+					{
+						// The parser has no notion of exports, the declaration that follows is kept as is
+						Mask(parseSource, identifierStart, offset);
+						exportStart = identifierStart;
+					}
+					else if (isDeclarationStart && (identifier == "module" || identifier == "import"))
+					{
+						// module ...; import ...;
+						auto declarationEnd = source.find(';', offset);
+						declarationEnd = declarationEnd == std::string_view::npos ? source.size() : declarationEnd + 1;
+						if (identifier == "module" && exportStart != std::string_view::npos)
+						{
+							moduleName = RemoveWhitespace(source.substr(offset, declarationEnd - offset - 1));
+							isInterface = !moduleName.empty() && moduleName.find(':') == std::string::npos;
+						}
+
+						Mask(parseSource, identifierStart, declarationEnd);
+						offset = declarationEnd;
+						exportStart = std::string_view::npos;
+						isDeclarationStart = true;
+					}
+					else
+					{
+						exportStart = std::string_view::npos;
+						isDeclarationStart = false;
+					}
+
+					isLineStart = false;
+				}
+				else
+				{
+					if (value == '{')
+					{
+						// An export block has its braces removed along with the keyword
+						auto isExportBlock = exportStart != std::string_view::npos;
+						if (isExportBlock)
+							Mask(parseSource, offset, offset + 1);
+						exportBlocks.push_back(isExportBlock);
+					}
+					else if (value == '}' && !exportBlocks.empty())
+					{
+						if (exportBlocks.back())
+							Mask(parseSource, offset, offset + 1);
+						exportBlocks.pop_back();
+					}
+
+					isDeclarationStart = value == ';' || value == '{' || value == '}';
+					exportStart = std::string_view::npos;
+					isLineStart = false;
+					offset++;
+				}
+			}
+
+			return isInterface;
+		}
+
+	private:
+		static size_t SkipLine(std::string_view source, size_t offset, bool allowContinuation)
+		{
+			while (offset < source.size() && source[offset] != '\n')
+			{
+				if (allowContinuation && source[offset] == '\\' && offset + 1 < source.size() && source[offset + 1] == '\n')
+					offset++;
+
+				offset++;
+			}
+
+			return offset;
+		}
+
+		static size_t SkipLiteral(std::string_view source, size_t offset)
+		{
+			auto quote = source[offset++];
+			while (offset < source.size() && source[offset] != quote && source[offset] != '\n')
+			{
+				if (source[offset] == '\\')
+					offset++;
+
+				offset++;
+			}
+
+			return std::min(offset + 1, source.size());
+		}
+
+		static size_t SkipRawLiteral(std::string_view source, size_t offset)
+		{
+			// R"delimiter( ... )delimiter"
+			auto delimiterEnd = source.find('(', offset);
+			if (delimiterEnd == std::string_view::npos)
+				return source.size();
+
+			auto terminator = ")" + std::string(source.substr(offset + 1, delimiterEnd - offset - 1)) + "\"";
+			auto literalEnd = source.find(terminator, delimiterEnd);
+			return literalEnd == std::string_view::npos ? source.size() : literalEnd + terminator.size();
+		}
+
+		static void Mask(std::string& parseSource, size_t start, size_t end)
+		{
+			for (auto offset = start; offset < end; offset++)
+			{
+				if (parseSource[offset] != '\n')
+					parseSource[offset] = ' ';
+			}
+		}
+
+		static std::string RemoveWhitespace(std::string_view value)
+		{
+			auto result = std::string();
+			for (auto character : value)
+			{
+				if (character != ' ' && character != '\t' && character != '\r' && character != '\n')
+					result += character;
+			}
+
+			return result;
+		}
+
+		static bool IsRawLiteralPrefix(std::string_view identifier)
+		{
+			return identifier == "R" || identifier == "LR" || identifier == "uR" || identifier == "UR" || identifier == "u8R";
+		}
+
+		static bool IsIdentifierCharacter(char value)
+		{
+			return (value >= 'a' && value <= 'z') ||
+				(value >= 'A' && value <= 'Z') ||
+				(value >= '0' && value <= '9') ||
+				value == '_';
+		}
+	};
+}
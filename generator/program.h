@@ -3,7 +3,20 @@
 // </copyright>
 
 #pragma once
+#include "generation-cache.h"
+#include "generator-options.h"
+#include "generator-statistics.h"
+#include "generator-statistics-file.h"
+#include "file-watcher.h"
+#include "mapped-file.h"
+#include "module-unit-scanner.h"
+#include "stream-buffers.h"
+#include "test-pre-scan.h"
 #include "TestBuilder.h"
+#include "test-runner-syntax-builder.h"
+#include "test-runner-writer.h"
+#include "test-shard-writer.h"
+#include "work-stealing-pool.h"
 
 using namespace Soup::Syntax;
 using namespace Soup::Syntax::InnerTree;
@@ -16,6 +29,11 @@ namespace Soup::Test
 	class Program
 	{
 	public:
+		/// <summary>
+		/// The generator version, cached state from any other version is discarded
+		/// </summary>
+		static constexpr std::string_view GeneratorVersion = "0.9.1";
+
 		/// <summary>
 		/// The main entry point of the program
 		/// </summary>
@@ -23,87 +41,873 @@ namespace Soup::Test
 		{
 			try
 			{
-				if (args.size() != 2)
+				auto options = ParseArguments(args);
+				if (options.Watch)
+					Watch(options);
+				else
+					Generate(options);
+
+				return 0;
+			}
+			catch (const std::exception& ex)
+			{
+				std::cout << "ERROR: " << ex.what() << std::endl;
+				return -1;
+			}
+		}
+
+		/// <summary>
+		/// Generate the test runners for every header under the requested directories
+		/// </summary>
+		static GeneratorStatistics Generate(const GeneratorOptions& options)
+		{
+			auto run = GeneratorRun();
+			for (auto& directory : options.Directories)
+			{
+				auto root = OpenRoot(directory, options);
+				GenerateRoot(root, options, run);
+			}
+
+			FinishRun(options, run);
+			return run.Statistics;
+		}
+
+		/// <summary>
+		/// Generate every root and then keep running, regenerating only the headers that change.
+		/// The manifest of each root stays loaded between batches so unchanged headers are never read again.
+		/// </summary>
+		static void Watch(const GeneratorOptions& options)
+		{
+			auto watcher = FileWatcher();
+			auto roots = std::vector<TestRoot>();
+			for (auto& directory : options.Directories)
+			{
+				roots.push_back(OpenRoot(directory, options));
+
+				// Start watching before the first pass so no edit made during it is missed
+				watcher.AddDirectory(roots.back().Directory, roots.back().GenDir);
+			}
+
+			RunWatchBatch(options, [&](GeneratorRun& run)
+			{
+				for (auto& root : roots)
 				{
-					throw std::runtime_error("Expected exactly one argument.");
+					GenerateRoot(root, options, run);
 				}
+			});
+
+			std::cout << "Watching " << roots.size() << " directories for changes." << std::endl;
+			while (true)
+			{
+				auto changes = watcher.WaitForChanges(WatchSettleTime);
+				RunWatchBatch(options, [&](GeneratorRun& run)
+				{
+					for (auto& root : roots)
+					{
+						GenerateChanges(root, changes, options, run);
+					}
+				});
+			}
+		}
+
+	private:
+		static constexpr std::chrono::milliseconds WatchSettleTime = std::chrono::milliseconds(100);
+
+		/// <summary>
+		/// A single header discovered in the test tree
+		/// </summary>
+		struct TestFile
+		{
+			std::filesystem::path File;
+			std::string IncludeDir;
+			std::filesystem::path GenDir;
+		};
+
+		/// <summary>
+		/// The buffered outcome of processing a single file
+		/// </summary>
+		struct TestFileResult
+		{
+			bool IsComplete = false;
+			bool HasLogErrors = false;
+			GeneratorStatistics Statistics;
+			std::string Log;
+			std::exception_ptr Error;
+			std::optional<GenerationCacheEntry> CacheEntry;
+		};
+
+		/// <summary>
+		/// A test tree with its own output folder and manifest
+		/// </summary>
+		struct TestRoot
+		{
+			std::filesystem::path Directory;
+			std::filesystem::path GenDir;
+			std::filesystem::path ManifestFile;
+			GenerationCache Cache;
+		};
+
+		/// <summary>
+		/// The accumulated outcome of one pass over one or more roots
+		/// </summary>
+		struct GeneratorRun
+		{
+			std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+			GeneratorStatistics Statistics;
+			std::vector<FileStatistics> Files;
+			std::vector<std::exception_ptr> Errors;
+		};
 
-				// Check that the provided directory exists
-				std::filesystem::path directory = args[1];
-				if (!std::filesystem::exists(directory))
+		static GeneratorOptions ParseArguments(const std::vector<std::string>& args)
+		{
+			auto options = GeneratorOptions();
+			for (size_t i = 1; i < args.size(); i++)
+			{
+				auto& argument = args[i];
+				if (argument == "-j")
+				{
+					if (i + 1 >= args.size())
+						throw std::runtime_error("Missing worker count for -j.");
+					options.WorkerCount = ParseWorkerCount(args[++i]);
+				}
+				else if (argument.starts_with("-j"))
+				{
+					options.WorkerCount = ParseWorkerCount(argument.substr(2));
+				}
+				else if (argument.starts_with("--verify="))
+				{
+					ParseVerifyLevel(argument.substr(9), options);
+				}
+				else if (argument.starts_with("--emitter="))
+				{
+					options.Emitter = ParseRunnerEmitter(argument.substr(10));
+				}
+				else if (argument.starts_with("--stats="))
+				{
+					options.StatisticsFile = argument.substr(8);
+					if (options.StatisticsFile.empty())
+						throw std::runtime_error("Missing statistics file for --stats.");
+				}
+				else if (argument.starts_with("--stats-slowest="))
+				{
+					options.StatisticsSlowestCount = ParseUnsigned(argument.substr(16), "slowest file count");
+				}
+				else if (argument.starts_with("--shards="))
 				{
-					throw std::runtime_error("Provided directory does not exist.");
+					options.ShardCount = ParseUnsigned(argument.substr(9), "shard count");
 				}
+				else if (argument == "--watch")
+				{
+					options.Watch = true;
+				}
+				else if (argument == "-v")
+				{
+					options.Verbosity = LogVerbosity::Detailed;
+				}
+				else if (argument.starts_with("--verbosity="))
+				{
+					options.Verbosity = ParseVerbosity(argument.substr(12));
+				}
+				else
+				{
+					options.Directories.push_back(argument);
+				}
+			}
 
-				std::string includeDir = "";
-				std::filesystem::path genDir = directory / "gen";
-				ProcessDirectory(directory, includeDir, genDir);
+			if (options.Directories.empty())
+			{
+				throw std::runtime_error("Expected at least one directory.");
+			}
 
-				return 0;
+			return options;
+		}
+
+		static size_t ParseWorkerCount(const std::string& value)
+		{
+			// Zero requests one worker per hardware thread
+			auto workerCount = ParseUnsigned(value, "worker count");
+			if (workerCount == 0)
+				return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+			return workerCount;
+		}
+
+		static void ParseVerifyLevel(const std::string& value, GeneratorOptions& options)
+		{
+			if (value == "off")
+			{
+				options.Verify = VerifyLevel::Off;
+			}
+			else if (value == "hash")
+			{
+				options.Verify = VerifyLevel::Hash;
+			}
+			else if (value == "full")
+			{
+				options.Verify = VerifyLevel::Full;
+			}
+			else if (value.starts_with("sample=") && value.ends_with("%"))
+			{
+				auto percent = ParseUnsigned(value.substr(7, value.size() - 8), "verify sample percent");
+				if (percent > 100)
+					throw std::runtime_error("Invalid verify sample percent: " + value);
+
+				options.Verify = VerifyLevel::Sample;
+				options.VerifySamplePercent = static_cast<uint32_t>(percent);
+			}
+			else
+			{
+				throw std::runtime_error("Unknown verify level: " + value);
+			}
+		}
+
+		static RunnerEmitter ParseRunnerEmitter(const std::string& value)
+		{
+			if (value == "text")
+				return RunnerEmitter::Text;
+			else if (value == "syntax")
+				return RunnerEmitter::Syntax;
+			else if (value == "compare")
+				return RunnerEmitter::Compare;
+			else
+				throw std::runtime_error("Unknown emitter: " + value);
+		}
+
+		static LogVerbosity ParseVerbosity(const std::string& value)
+		{
+			if (value == "quiet")
+				return LogVerbosity::Quiet;
+			else if (value == "normal")
+				return LogVerbosity::Normal;
+			else if (value == "detailed")
+				return LogVerbosity::Detailed;
+			else
+				throw std::runtime_error("Unknown verbosity: " + value);
+		}
+
+		static size_t ParseUnsigned(const std::string& value, std::string_view name)
+		{
+			size_t parsedLength = 0;
+			unsigned long result = 0;
+			try
+			{
+				result = std::stoul(value, &parsedLength);
+			}
+			catch (const std::exception&)
+			{
+				parsedLength = 0;
+			}
+
+			if (parsedLength == 0 || parsedLength != value.size())
+				throw std::runtime_error("Invalid " + std::string(name) + ": " + value);
+
+			return result;
+		}
+
+		static TestRoot OpenRoot(const std::filesystem::path& directory, const GeneratorOptions& options)
+		{
+			// Check that the provided directory exists
+			if (!std::filesystem::exists(directory))
+			{
+				throw std::runtime_error("Provided directory does not exist: " + directory.string());
+			}
+
+			// Load the state of the previous run to skip unchanged headers
+			auto genDir = directory / "gen";
+			auto manifestFile = genDir / GenerationCache::FileName;
+			auto cache = GenerationCache::Load(manifestFile, GeneratorVersion, GetCacheSettings(options));
+			return TestRoot{ directory, std::move(genDir), std::move(manifestFile), std::move(cache) };
+		}
+
+		/// <summary>
+		/// The options that change what a run checks or writes for a header, a cached result is only trusted under the same ones
+		/// </summary>
+		static std::string GetCacheSettings(const GeneratorOptions& options)
+		{
+			auto result = std::string("emitter=");
+			switch (options.Emitter)
+			{
+				case RunnerEmitter::Text:
+					result += "text";
+					break;
+				case RunnerEmitter::Syntax:
+					result += "syntax";
+					break;
+				case RunnerEmitter::Compare:
+					result += "compare";
+					break;
+			}
+
+			result += " verify=";
+			switch (options.Verify)
+			{
+				case VerifyLevel::Off:
+					result += "off";
+					break;
+				case VerifyLevel::Hash:
+					result += "hash";
+					break;
+				case VerifyLevel::Full:
+					result += "full";
+					break;
+				case VerifyLevel::Sample:
+					result += "sample=" + std::to_string(options.VerifySamplePercent) + "%";
+					break;
+			}
+
+			return result;
+		}
+
+		static void GenerateRoot(TestRoot& root, const GeneratorOptions& options, GeneratorRun& run)
+		{
+			// List the entire tree up front so the files can be processed in any order
+			auto phaseStart = std::chrono::steady_clock::now();
+			std::vector<TestFile> files = {};
+			ProcessDirectory(root.Directory, "", root.GenDir, options, files);
+			run.Statistics.EndPhase(GeneratorPhase::List, phaseStart);
+
+			// The full listing replaces the manifest, which drops the entries of deleted headers
+			auto results = ProcessFiles(files, options, root.Cache);
+			RemoveUnlistedTestFiles(root, files, options);
+			root.Cache = GenerationCache();
+			UpdateRoot(root, files, results, options, run);
+		}
+
+		/// <summary>
+		/// Delete the runner of every header in the manifest that is missing from the listing
+		/// </summary>
+		static void RemoveUnlistedTestFiles(TestRoot& root, const std::vector<TestFile>& files, const GeneratorOptions& options)
+		{
+			auto listedFiles = std::unordered_set<std::string>();
+			for (auto& file : files)
+				listedFiles.insert(GetIncludeFile(file));
+
+			auto unlistedFiles = std::vector<std::filesystem::path>();
+			for (auto& [includeFile, entry] : root.Cache.GetEntries())
+			{
+				if (!listedFiles.contains(includeFile))
+					unlistedFiles.push_back(root.Directory / includeFile.substr(1));
+			}
+
+			for (auto& file : unlistedFiles)
+			{
+				RemoveTestFile(root, GetTestFile(root, file), options);
+			}
+		}
+
+		static void GenerateChanges(
+			TestRoot& root,
+			const std::vector<FileChange>& changes,
+			const GeneratorOptions& options,
+			GeneratorRun& run)
+		{
+			auto phaseStart = std::chrono::steady_clock::now();
+			std::vector<TestFile> files = {};
+			auto hasRemovedFiles = false;
+			for (auto& change : changes)
+			{
+				if (!IsWithinDirectory(change.Path, root.Directory) || IsWithinDirectory(change.Path, root.GenDir))
+					continue;
+
+				if (change.Type == FileChangeType::DirectoryCreated || change.Type == FileChangeType::DirectoryRemoved)
+				{
+					// A rescan may follow lost removals, drop whatever is no longer on disk before listing the tree again
+					auto includeDir = std::string();
+					auto genDir = std::filesystem::path();
+					GetOutputLocation(root, change.Path, includeDir, genDir);
+					hasRemovedFiles |= RemoveMissingTestFiles(root, includeDir, options);
+					if (change.Type == FileChangeType::DirectoryCreated && std::filesystem::is_directory(change.Path))
+						ProcessDirectory(change.Path, includeDir, genDir, options, files);
+				}
+				else if (IsTestSource(change.Path))
+				{
+					// A file written just before its directory was removed is only seen as a change
+					auto testFile = GetTestFile(root, change.Path);
+					if (change.Type == FileChangeType::Removed || !std::filesystem::exists(change.Path))
+					{
+						RemoveTestFile(root, testFile, options);
+						hasRemovedFiles = true;
+					}
+					else
+					{
+						files.push_back(std::move(testFile));
+					}
+				}
+			}
+
+			// A header in a new directory is also reported on its own
+			std::sort(
+				files.begin(),
+				files.end(),
+				[](const TestFile& lhs, const TestFile& rhs) { return lhs.File < rhs.File; });
+			files.erase(
+				std::unique(
+					files.begin(),
+					files.end(),
+					[](const TestFile& lhs, const TestFile& rhs) { return lhs.File == rhs.File; }),
+				files.end());
+
+			run.Statistics.EndPhase(GeneratorPhase::List, phaseStart);
+			if (files.empty() && !hasRemovedFiles)
+				return;
+
+			auto results = ProcessFiles(files, options, root.Cache);
+			UpdateRoot(root, files, results, options, run);
+		}
+
+		static void UpdateRoot(
+			TestRoot& root,
+			const std::vector<TestFile>& files,
+			std::vector<TestFileResult>& results,
+			const GeneratorOptions& options,
+			GeneratorRun& run)
+		{
+			// Persist the state of every file that succeeded, failed files are retried next run
+			for (size_t i = 0; i < files.size(); i++)
+			{
+				auto& result = results[i];
+				auto includeFile = GetIncludeFile(files[i]);
+				if (result.CacheEntry.has_value())
+					root.Cache.Set(std::move(includeFile), std::move(result.CacheEntry.value()));
+				else
+					root.Cache.Remove(includeFile);
+
+				run.Statistics += result.Statistics;
+				if (result.Error != nullptr)
+					run.Errors.push_back(result.Error);
+			}
+
+			root.Cache.Save(root.ManifestFile, GeneratorVersion, GetCacheSettings(options));
+
+			if (options.ShardCount > 0)
+				WriteShards(root, options);
+
+			for (size_t i = 0; i < files.size(); i++)
+			{
+				run.Files.push_back(FileStatistics{ files[i].File.generic_string(), results[i].Statistics });
+			}
+		}
+
+		/// <summary>
+		/// Regroup every runner in the root into the shard units, the manifest holds the test classes
+		/// and test count of each header so the shards never need the headers themselves
+		/// </summary>
+		static void WriteShards(const TestRoot& root, const GeneratorOptions& options)
+		{
+			auto runners = std::vector<ShardRunner>();
+			for (auto& [includeFile, entry] : root.Cache.GetEntries())
+			{
+				if (entry.TestClasses.empty())
+					continue;
+
+				// A header runner is included relative to the root gen folder that holds the shards
+				auto runnerFile = std::filesystem::path(includeFile.substr(1)).replace_extension(".gen.h");
+				runners.push_back(ShardRunner{
+					runnerFile.generic_string(),
+					entry.ModuleName,
+					entry.TestClasses,
+					entry.TestCount + TestShardWriter::FileWeight });
+			}
+
+			auto shards = TestShardWriter::AssignShards(runners, options.ShardCount);
+			auto content = std::string();
+			for (size_t shard = 0; shard < shards.size(); shard++)
+			{
+				content.clear();
+				TestShardWriter::WriteShard(shard, shards.size(), shards[shard], content);
+				WriteGeneratedFile(root.GenDir / TestShardWriter::GetShardFileName(shard), content, options);
+			}
+
+			content.clear();
+			TestShardWriter::WriteRegistry(shards.size(), content);
+			WriteGeneratedFile(root.GenDir / TestShardWriter::RegistryFileName, content, options);
+
+			// Drop the units left over from a larger shard count, they would register their runners twice
+			for (auto shard = shards.size(); ; shard++)
+			{
+				auto error = std::error_code();
+				auto staleFile = root.GenDir / TestShardWriter::GetShardFileName(shard);
+				if (!std::filesystem::remove(staleFile, error))
+					break;
+
+				if (options.Verbosity == LogVerbosity::Detailed)
+					std::cout << "Removed: " << staleFile << "\n";
+			}
+		}
+
+		static void WriteGeneratedFile(
+			const std::filesystem::path& file,
+			std::string_view content,
+			const GeneratorOptions& options)
+		{
+			if (WriteFileIfChanged(file, content) && options.Verbosity == LogVerbosity::Detailed)
+				std::cout << "GEN: " << file << "\n";
+		}
+
+		/// <summary>
+		/// Remove the manifest entry and runner of every file under the include folder that no longer exists
+		/// </summary>
+		static bool RemoveMissingTestFiles(TestRoot& root, const std::string& includeDir, const GeneratorOptions& options)
+		{
+			auto missingFiles = std::vector<std::filesystem::path>();
+			auto includePrefix = includeDir + "/";
+			for (auto& [includeFile, entry] : root.Cache.GetEntries())
+			{
+				if (!includeFile.starts_with(includePrefix))
+					continue;
+
+				auto file = root.Directory / includeFile.substr(1);
+				if (!std::filesystem::exists(file))
+					missingFiles.push_back(std::move(file));
+			}
+
+			for (auto& file : missingFiles)
+			{
+				RemoveTestFile(root, GetTestFile(root, file), options);
+			}
+
+			return !missingFiles.empty();
+		}
+
+		static void RemoveTestFile(TestRoot& root, const TestFile& testFile, const GeneratorOptions& options)
+		{
+			root.Cache.Remove(GetIncludeFile(testFile));
+
+			auto targetGenFile = GetRunnerFile(testFile);
+			auto error = std::error_code();
+			if (std::filesystem::remove(targetGenFile, error) && options.Verbosity == LogVerbosity::Detailed)
+				std::cout << "Removed: " << targetGenFile << "\n";
+		}
+
+		static void FinishRun(const GeneratorOptions& options, GeneratorRun& run)
+		{
+			auto& statistics = run.Statistics;
+			statistics.TotalDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - run.Start);
+
+			if (options.Verbosity != LogVerbosity::Quiet && statistics.FileCount > 0)
+			{
+				std::cout << "Pre-scan rejected " << statistics.PreScanRejectedCount << " of " << statistics.FileCount << " files.\n";
+				std::cout << "Generated " << statistics.GeneratedCount << " of " << statistics.FileCount << " files, " <<
+					statistics.UpToDateCount << " up to date, in " <<
+					std::chrono::duration_cast<std::chrono::milliseconds>(statistics.TotalDuration).count() << " ms." << std::endl;
+			}
+
+			if (!options.StatisticsFile.empty())
+			{
+				GeneratorStatisticsFile::Save(
+					options.StatisticsFile,
+					GeneratorVersion,
+					options,
+					statistics,
+					run.Files);
+			}
+
+			ThrowIfFailed(run.Errors);
+		}
+
+		static void RunWatchBatch(const GeneratorOptions& options, const std::function<void(GeneratorRun&)>& batch)
+		{
+			// A failure only affects the current batch, the next change gets a fresh attempt
+			try
+			{
+				auto run = GeneratorRun();
+				batch(run);
+				FinishRun(options, run);
 			}
 			catch (const std::exception& ex)
 			{
 				std::cout << "ERROR: " << ex.what() << std::endl;
-				return -1;
 			}
 		}
 
-	private:
+		static TestFile GetTestFile(const TestRoot& root, const std::filesystem::path& file)
+		{
+			auto testFile = TestFile{ file, std::string(), std::filesystem::path() };
+			GetOutputLocation(root, file.parent_path(), testFile.IncludeDir, testFile.GenDir);
+			return testFile;
+		}
+
+		/// <summary>
+		/// Build the include path and output folder for a directory from its location under the root
+		/// </summary>
+		static void GetOutputLocation(
+			const TestRoot& root,
+			const std::filesystem::path& directory,
+			std::string& includeDir,
+			std::filesystem::path& genDir)
+		{
+			includeDir.clear();
+			genDir = root.GenDir;
+			for (auto& part : directory.lexically_relative(root.Directory))
+			{
+				if (part == "." || part.empty())
+					continue;
+
+				includeDir += "/" + part.string();
+				genDir /= part;
+			}
+		}
+
+		static std::string GetIncludeFile(const TestFile& testFile)
+		{
+			return testFile.IncludeDir + "/" + testFile.File.filename().string();
+		}
+
+		/// <summary>
+		/// A header gets a runner header, a module unit gets a runner module unit that imports it
+		/// </summary>
+		static std::filesystem::path GetRunnerFile(const TestFile& testFile)
+		{
+			auto extension = IsModuleSource(testFile.File) ? ".gen.cpp" : ".gen.h";
+			return testFile.GenDir / testFile.File.filename().replace_extension(extension);
+		}
+
+		static bool IsTestSource(const std::filesystem::path& file)
+		{
+			return file.extension() == ".h" || IsModuleSource(file);
+		}
+
+		static bool IsModuleSource(const std::filesystem::path& file)
+		{
+			return file.extension() == ".cpp" || file.extension() == ".cppm";
+		}
+
+		static bool IsWithinDirectory(const std::filesystem::path& path, const std::filesystem::path& directory)
+		{
+			auto relativePath = path.lexically_relative(directory);
+			return !relativePath.empty() && *relativePath.begin() != "..";
+		}
+
 		static void ProcessDirectory(
 			const std::filesystem::path& directory,
 			const std::string& includeDir,
-			const std::filesystem::path& genDir)
+			const std::filesystem::path& genDir,
+			const GeneratorOptions& options,
+			std::vector<TestFile>& files)
 		{
-			std::cout << "Directory: " << directory << std::endl;
-			for(auto& childItem : std::filesystem::directory_iterator(directory))
+			auto isDetailed = options.Verbosity == LogVerbosity::Detailed;
+			if (isDetailed)
+				std::cout << "Directory: " << directory << "\n";
+
+			// Sort the children so the listing order, and everything derived from it, is stable
+			auto children = std::vector<std::filesystem::directory_entry>(
+				std::filesystem::directory_iterator(directory),
+				std::filesystem::directory_iterator());
+			std::sort(
+				children.begin(),
+				children.end(),
+				[](const auto& lhs, const auto& rhs) { return lhs.path() < rhs.path(); });
+
+			for (auto& childItem : children)
 			{
 				if (childItem.is_directory())
 				{
 					if (childItem.path() == genDir)
 					{
-						std::cout << "Skipping output gen folder." << std::endl;
+						if (isDetailed)
+							std::cout << "Skipping output gen folder.\n";
 					}
 					else
 					{
 						// Update gen target directory
 						auto secondFromLastEntry = --childItem.path().end();
-						std::cout << *secondFromLastEntry << std::endl;
+						if (isDetailed)
+							std::cout << *secondFromLastEntry << "\n";
 						auto childIncludeDir = includeDir + "/" + secondFromLastEntry->string();
 						auto childGenDir = genDir / *secondFromLastEntry;
-						ProcessDirectory(childItem, childIncludeDir, childGenDir);
+						ProcessDirectory(childItem, childIncludeDir, childGenDir, options, files);
 					}
 				}
-				else if (childItem.path().extension() == ".h")
+				else if (IsTestSource(childItem.path()))
+				{
+					// Queue the C++ file
+					files.push_back(TestFile{ childItem.path(), includeDir, genDir });
+				}
+			}
+		}
+
+		static std::vector<TestFileResult> ProcessFiles(
+			const std::vector<TestFile>& files,
+			const GeneratorOptions& options,
+			const GenerationCache& cache)
+		{
+			auto results = std::vector<TestFileResult>(files.size());
+			auto logMutex = std::mutex();
+			size_t nextLogIndex = 0;
+
+			auto pool = WorkStealingPool(options.WorkerCount);
+			pool.Run(files.size(), [&](size_t index)
+			{
+				auto& result = results[index];
+				auto fileStart = std::chrono::steady_clock::now();
+				auto log = std::stringstream();
+				try
+				{
+					ProcessFile(files[index], options, cache, result, log);
+				}
+				catch (const std::exception& ex)
+				{
+					log << "ERROR: " << ex.what() << "\n";
+					result.Error = std::current_exception();
+				}
+
+				result.Statistics.TotalDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(
+					std::chrono::steady_clock::now() - fileStart);
+
+				// Only keep the per file log when it will be shown, failures and errors are always shown
+				if (options.Verbosity == LogVerbosity::Detailed || result.Error != nullptr || result.HasLogErrors)
+					result.Log = log.str();
+
+				// Write out the completed prefix of the listing so logs never interleave
+				auto lock = std::lock_guard<std::mutex>(logMutex);
+				result.IsComplete = true;
+				auto hasOutput = false;
+				while (nextLogIndex < results.size() && results[nextLogIndex].IsComplete)
 				{
-					// Process the C++ file
-					ProcessFile(childItem.path(), includeDir, genDir);
+					if (!results[nextLogIndex].Log.empty())
+					{
+						std::cout << results[nextLogIndex].Log;
+						results[nextLogIndex].Log.clear();
+						hasOutput = true;
+					}
+
+					nextLogIndex++;
 				}
+
+				if (hasOutput)
+					std::cout.flush();
+			});
+
+			return results;
+		}
+
+		static void ThrowIfFailed(const std::vector<std::exception_ptr>& errors)
+		{
+			// Report failures in listing order regardless of which worker hit them
+			if (errors.size() == 1)
+			{
+				std::rethrow_exception(errors.front());
+			}
+			else if (errors.size() > 1)
+			{
+				throw std::runtime_error(std::to_string(errors.size()) + " files failed to generate.");
 			}
 		}
 
 		static void ProcessFile(
-			const std::filesystem::path& file,
-			const std::string& includeDir,
-			const std::filesystem::path& genDir)
+			const TestFile& testFile,
+			const GeneratorOptions& options,
+			const GenerationCache& cache,
+			TestFileResult& result,
+			std::ostream& log)
 		{
+			auto& file = testFile.File;
+			auto& statistics = result.Statistics;
+			statistics.FileCount = 1;
+			auto phaseStart = std::chrono::steady_clock::now();
 			try
 			{
-				std::cout << file << std::endl;
-				auto timeStart = std::chrono::high_resolution_clock::now();
+				log << file << "\n";
+				auto includeFile = GetIncludeFile(testFile);
+				auto targetGenFile = GetRunnerFile(testFile);
+				auto fileSize = std::filesystem::file_size(file);
+				auto lastWriteTime = static_cast<int64_t>(
+					std::filesystem::last_write_time(file).time_since_epoch().count());
+
+				// Skip without reading the file when it is untouched since the last run
+				auto cacheEntry = cache.TryGet(includeFile);
+				if (cacheEntry != nullptr &&
+					cacheEntry->FileSize == fileSize &&
+					cacheEntry->LastWriteTime == lastWriteTime &&
+					IsGenFileCurrent(*cacheEntry, targetGenFile))
+				{
+					log << "Up To Date." << "\n";
+					result.CacheEntry = *cacheEntry;
+					statistics.UpToDateCount = 1;
+					statistics.EndPhase(GeneratorPhase::Read, phaseStart);
+					return;
+				}
+
+				// Map the file once and share the view between hashing, parsing and verification
+				auto sourceFile = MappedFile(file);
+				auto source = sourceFile.GetContent();
+				auto contentHash = GenerationCache::HashContent(source);
+				statistics.BytesRead = source.size();
+				statistics.EndPhase(GeneratorPhase::Read, phaseStart);
+				if (cacheEntry != nullptr &&
+					cacheEntry->ContentHash == contentHash &&
+					IsGenFileCurrent(*cacheEntry, targetGenFile))
+				{
+					// Only the timestamp moved, refresh it so the next run takes the fast path
+					log << "Up To Date." << "\n";
+					result.CacheEntry = *cacheEntry;
+					result.CacheEntry->FileSize = fileSize;
+					result.CacheEntry->LastWriteTime = lastWriteTime;
+					statistics.UpToDateCount = 1;
+					return;
+				}
+
+				// Most headers are helpers, reject the ones that cannot hold a test without parsing them
+				auto mayContainTests = TestPreScan::MayContainTests(source);
+				statistics.EndPhase(GeneratorPhase::PreScan, phaseStart);
+				if (!mayContainTests)
+				{
+					log << "No Tests Found." << "\n";
+					RemoveStaleRunner(targetGenFile, log);
+					statistics.PreScanRejectedCount = 1;
+					result.CacheEntry = GenerationCacheEntry{ contentHash, fileSize, lastWriteTime, 0, {}, {} };
+					return;
+				}
 
-				auto sourceFile = std::ifstream(file);
-				auto syntaxTree = SyntaxParser::Parse(sourceFile);
+				// A module unit is parsed with its module syntax blanked out, anything but a primary interface cannot be imported.
+				// The runner is a separate module, so every test class found here must be exported by the interface.
+				auto moduleName = std::string();
+				auto parseSource = source;
+				auto parseHash = contentHash;
+				thread_local std::string moduleParseSource;
+				if (IsModuleSource(file))
+				{
+					auto isInterface = ModuleUnitScanner::TryScanInterface(source, moduleName, moduleParseSource);
+					statistics.EndPhase(GeneratorPhase::PreScan, phaseStart);
+					if (!isInterface)
+					{
+						log << "Not A Module Interface." << "\n";
+						RemoveStaleRunner(targetGenFile, log);
+						statistics.PreScanRejectedCount = 1;
+						result.CacheEntry = GenerationCacheEntry{ contentHash, fileSize, lastWriteTime, 0, {}, {} };
+						return;
+					}
 
-				VerifyResult(syntaxTree, file);
+					parseSource = moduleParseSource;
+					parseHash = GenerationCache::HashContent(parseSource);
+				}
+
+				auto sourceBuffer = MemoryStreamBuffer(parseSource);
+				auto sourceStream = std::istream(&sourceBuffer);
+				auto syntaxTree = SyntaxParser::Parse(sourceStream);
+				statistics.ParsedCount = 1;
+				statistics.EndPhase(GeneratorPhase::Parse, phaseStart);
 
-				auto timeStop = std::chrono::high_resolution_clock::now();
-				auto duration = std::chrono::duration_cast<std::chrono::duration<double>>(timeStop - timeStart);
+				switch (GetFileVerifyLevel(options, includeFile))
+				{
+					case VerifyLevel::Off:
+						break;
+					case VerifyLevel::Hash:
+						VerifyResultHash(syntaxTree, parseHash);
+						break;
+					default:
+						VerifyResult(syntaxTree, parseSource, log);
+						break;
+				}
 
-				// std::cout << "Done: " << duration.count() << " seconds." << std::endl;
+				statistics.EndPhase(GeneratorPhase::Verify, phaseStart);
 
 				// Build the collection of test classes
-				TestBuilder testBuilder;
+				auto testBuilder = TestBuilder(log);
 				syntaxTree->GetTranslationUnit().Accept(testBuilder);
+				result.HasLogErrors = testBuilder.HasErrors();
+				statistics.EndPhase(GeneratorPhase::Collect, phaseStart);
 
 				// Print the entire syntax tree
 				// std::stringstream message;
@@ -111,22 +915,51 @@ namespace Soup::Test
 				// syntaxTree->GetTranslationUnit().Accept(writer);
 				// std::cout << message.str() << "\n";
 
+				auto entry = GenerationCacheEntry{ contentHash, fileSize, lastWriteTime, 0, moduleName, {} };
+
 				// Build up the runner and save it to file
 				if (!testBuilder.GetTestClasses().empty())
 				{
-					auto includeFile = includeDir + "/" + file.filename().string();
-					auto targetGenFile = genDir / file.filename().replace_extension(".gen.h"); 
-					auto runnerSyntaxTree = BuildTestRunner(testBuilder, includeFile);
-
-					// Write gen file
-					std::cout << "GEN: " << targetGenFile << std::endl;
-					auto runnerFile = std::ofstream(targetGenFile);
-					runnerSyntaxTree->Write(runnerFile);
+					for (auto& testClass : testBuilder.GetTestClasses())
+					{
+						entry.TestClasses.push_back(GetQualifiedName(testClass));
+						statistics.TestClassCount++;
+						for (auto& testMethod : testClass.GetTestMethods())
+						{
+							statistics.TestMethodCount++;
+							statistics.TestCount += testMethod.IsTheory ? testMethod.Theories.size() : 1;
+						}
+					}
+
+					entry.TestCount = statistics.TestCount;
+
+					// Reuse the runner buffer of this worker across files
+					thread_local std::string runnerContent;
+					runnerContent.clear();
+					BuildTestRunner(testBuilder, includeFile, moduleName, options.Emitter, runnerContent);
+					statistics.EndPhase(GeneratorPhase::Emit, phaseStart);
+
+					// Write gen file, leaving identical output untouched so its timestamp does not trigger a rebuild
+					if (WriteFileIfChanged(targetGenFile, runnerContent))
+					{
+						log << "GEN: " << targetGenFile << "\n";
+						statistics.GeneratedCount = 1;
+						statistics.BytesWritten = runnerContent.size();
+					}
+					else
+					{
+						log << "Unchanged: " << targetGenFile << "\n";
+					}
+
+					statistics.EndPhase(GeneratorPhase::Write, phaseStart);
 				}
 				else
 				{
-					std::cout << "No Tests Found." << std::endl;
+					log << "No Tests Found." << "\n";
+					RemoveStaleRunner(targetGenFile, log);
 				}
+
+				result.CacheEntry = std::move(entry);
 			}
 			catch(const std::exception& e)
 			{
@@ -136,519 +969,126 @@ namespace Soup::Test
 			}
 		}
 
-		static void VerifyResult(const std::shared_ptr<const SyntaxTree>& syntaxTree, const std::filesystem::path& file)
+		static void BuildTestRunner(
+			const TestBuilder& testBuilder,
+			const std::string& includeFile,
+			std::string_view moduleName,
+			RunnerEmitter emitter,
+			std::string& output)
 		{
-			// Read the whole file
-			std::ifstream sourceFile(file);
-			std::string source((std::istreambuf_iterator<char>(sourceFile)),
-				std::istreambuf_iterator<char>());
-
-			// Verifiy we can handle this file...
-			std::stringstream output;
-			syntaxTree->Write(output);
-			auto result = output.str();
+			if (emitter != RunnerEmitter::Syntax)
+			{
+				TestRunnerWriter::WriteTestRunner(testBuilder, includeFile, moduleName, output);
+			}
 
-			if (source != result)
+			if (emitter != RunnerEmitter::Text)
 			{
-				std::cout << "Actual: " << result << std::endl;
-				throw std::runtime_error("Verify output text matches input source.");
-				std::cout << "FAILED!" << std::endl;
+				auto referenceContent = std::string();
+				auto referenceBuffer = StringStreamBuffer(referenceContent);
+				auto referenceStream = std::ostream(&referenceBuffer);
+				auto runnerSyntaxTree = TestRunnerSyntaxBuilder::BuildTestRunner(testBuilder, includeFile, moduleName);
+				runnerSyntaxTree->Write(referenceStream);
+
+				if (emitter == RunnerEmitter::Syntax)
+				{
+					output = std::move(referenceContent);
+				}
+				else if (output != referenceContent)
+				{
+					throw std::runtime_error("Text emitter output does not match the syntax emitter output.");
+				}
 			}
 		}
 
-		static std::shared_ptr<const SyntaxTree> BuildTestRunner(
-			TestBuilder& testBuilder,
-			const std::string& file)
+		/// <summary>
+		/// Drop the runner left from when the file still held tests, it would keep registering the removed tests
+		/// </summary>
+		static void RemoveStaleRunner(const std::filesystem::path& targetGenFile, std::ostream& log)
 		{
-			// Build up the test runner
-			std::vector<std::shared_ptr<const Declaration>> declarations = {};
-			for (auto& testClassEntry : testBuilder.GetTestClasses())
+			auto error = std::error_code();
+			if (std::filesystem::remove(targetGenFile, error))
+				log << "Removed: " << targetGenFile << "\n";
+		}
+
+		static bool IsGenFileCurrent(
+			const GenerationCacheEntry& cacheEntry,
+			const std::filesystem::path& targetGenFile)
+		{
+			// A header without tests has no output, otherwise the output must still be on disk
+			return cacheEntry.TestClasses.empty() != std::filesystem::exists(targetGenFile);
+		}
+
+		static std::string GetQualifiedName(const TestClass& testClass)
+		{
+			std::string result;
+			for (auto& qualifier : testClass.GetQualifiers())
 			{
-				auto& testClass = testClassEntry.second;
-				auto testRunnerFunction = BuildTestRunnerFunction(testClass, file);
-				declarations.push_back(testRunnerFunction);
+				result += qualifier;
+				result += "::";
 			}
 
-			auto translationUnit = SyntaxFactory::CreateTranslationUnit(
-				SyntaxFactory::CreateSyntaxList<Declaration>(std::move(declarations)),
-				SyntaxFactory::CreateKeywordToken(SyntaxTokenType::EndOfFile));
+			result += testClass.GetName();
+			return result;
+		}
 
-			return std::make_shared<const SyntaxTree>(
-				std::move(translationUnit));
+		static bool WriteFileIfChanged(const std::filesystem::path& file, std::string_view content)
+		{
+			if (std::filesystem::exists(file) && MappedFile(file).GetContent() == content)
+				return false;
+
+			std::filesystem::create_directories(file.parent_path());
+			auto outputFile = std::ofstream(file, std::ios::binary);
+			outputFile.write(content.data(), content.size());
+			if (!outputFile)
+				throw std::runtime_error("Failed to write file: " + file.string());
+
+			return true;
 		}
 
-		static std::shared_ptr<const Declaration> BuildTestRunnerFunction(
-			const TestClass& testClass,
-			const std::string& file)
+		static VerifyLevel GetFileVerifyLevel(const GeneratorOptions& options, const std::string& includeFile)
 		{
-			// Build up the class type with qualifier
-			std::vector<std::shared_ptr<const SyntaxNode>> namespaceIdentifiers = {};
-			std::vector<std::shared_ptr<const SyntaxToken>> namespaceSeparators = {};
+			if (options.Verify != VerifyLevel::Sample)
+				return options.Verify;
 
-			for (auto& qualifier : testClass.GetQualifiers())
+			// Select the sample by path so the same files are checked on every run
+			auto bucket = GenerationCache::HashContent(includeFile) % 100;
+			return bucket < options.VerifySamplePercent ? VerifyLevel::Full : VerifyLevel::Off;
+		}
+
+		static void VerifyResultHash(
+			const std::shared_ptr<const SyntaxTree>& syntaxTree,
+			uint64_t contentHash)
+		{
+			// Hash the serialized tree as it is written so the output is never held in memory
+			auto hashBuffer = HashStreamBuffer();
+			auto output = std::ostream(&hashBuffer);
+			syntaxTree->Write(output);
+
+			if (hashBuffer.GetHash() != contentHash)
 			{
-				namespaceIdentifiers.push_back(
-					SyntaxFactory::CreateSimpleIdentifier(
-						SyntaxFactory::CreateUniqueToken(SyntaxTokenType::Identifier, qualifier)));
-				namespaceSeparators.push_back(
-					SyntaxFactory::CreateKeywordToken(SyntaxTokenType::DoubleColon));
-			}
-
-			auto testClassType = SyntaxFactory::CreateTypeSpecifierSequence(
-				SyntaxFactory::CreateIdentifierType(
-					SyntaxFactory::CreateNestedNameSpecifier(
-						SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>(
-							std::move(namespaceIdentifiers),
-							std::move(namespaceSeparators))),
-					SyntaxFactory::CreateSimpleIdentifier(
-						SyntaxFactory::CreateUniqueToken(
-							SyntaxTokenType::Identifier,
-							testClass.GetName()))));
-
-			// #include "[TEST_FILE]"
-			// auto className = "[CLASS_NAME]"
-			// auto testClass = std::make_unique<[CLASS_TYPE]>();
-			// TestState state = { 0, 0 };
-			auto classNameLiteral = "\"" + testClass.GetName() + "\"";
-			std::vector<std::shared_ptr<const Statement>> statements = 
-			{
-				SyntaxFactory::CreateDeclarationStatement(
-					SyntaxFactory::CreateSimpleDeclaration(
-						SyntaxFactory::CreateDeclarationSpecifierSequence(
-							SyntaxFactory::CreatePrimitiveDataTypeSpecifier(
-								PrimitiveDataType::Auto,
-								SyntaxFactory::CreateKeywordToken(
-									SyntaxTokenType::Auto,
-									{
-										SyntaxFactory::CreateTrivia("\n"),
-										SyntaxFactory::CreateTrivia("	"),
-									},
-									{}))),
-						SyntaxFactory::CreateInitializerDeclaratorList(
-							SyntaxFactory::CreateSyntaxSeparatorList<InitializerDeclarator>(
-								{
-									SyntaxFactory::CreateInitializerDeclarator(
-										SyntaxFactory::CreateSimpleIdentifier(
-											SyntaxFactory::CreateUniqueToken(
-												SyntaxTokenType::Identifier,
-												"className",
-												{
-													SyntaxFactory::CreateTrivia(" "),
-												},
-												{})),
-										SyntaxFactory::CreateValueEqualInitializer(
-											SyntaxFactory::CreateKeywordToken(
-												SyntaxTokenType::Equal,
-												{
-													SyntaxFactory::CreateTrivia(" "),
-												},
-												{}),
-											SyntaxFactory::CreateLiteralExpression(
-												LiteralType::Integer,
-												SyntaxFactory::CreateUniqueToken(
-													SyntaxTokenType::StringLiteral,
-													classNameLiteral,
-													{
-														SyntaxFactory::CreateTrivia(" "),
-													},
-													{})))),
-								},
-								{})),
-						SyntaxFactory::CreateKeywordToken(SyntaxTokenType::Semicolon))),
-				SyntaxFactory::CreateDeclarationStatement(
-					SyntaxFactory::CreateSimpleDeclaration(
-						SyntaxFactory::CreateDeclarationSpecifierSequence(
-							SyntaxFactory::CreatePrimitiveDataTypeSpecifier(
-								PrimitiveDataType::Auto,
-								SyntaxFactory::CreateKeywordToken(
-									SyntaxTokenType::Auto,
-									{
-										SyntaxFactory::CreateTrivia("\n"),
-										SyntaxFactory::CreateTrivia("	"),
-									},
-									{}))),
-						SyntaxFactory::CreateInitializerDeclaratorList(
-							SyntaxFactory::CreateSyntaxSeparatorList<InitializerDeclarator>(
-								{
-									SyntaxFactory::CreateInitializerDeclarator(
-										SyntaxFactory::CreateSimpleIdentifier(
-											SyntaxFactory::CreateUniqueToken(
-												SyntaxTokenType::Identifier,
-												"testClass",
-												{
-													SyntaxFactory::CreateTrivia(" "),
-												},
-												{})),
-										SyntaxFactory::CreateValueEqualInitializer(
-											SyntaxFactory::CreateKeywordToken(
-												SyntaxTokenType::Equal,
-												{
-													SyntaxFactory::CreateTrivia(" "),
-												},
-												{}),
-											SyntaxFactory::CreateInvocationExpression(
-												SyntaxFactory::CreateIdentifierExpression(
-													SyntaxFactory::CreateNestedNameSpecifier(
-														SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>(
-															{
-																SyntaxFactory::CreateSimpleIdentifier(
-																	SyntaxFactory::CreateUniqueToken(
-																		SyntaxTokenType::Identifier,
-																		"std",
-																		{
-																			SyntaxFactory::CreateTrivia(" "),
-																		},
-																		{})),
-															},
-															{
-																SyntaxFactory::CreateKeywordToken(SyntaxTokenType::DoubleColon),
-															})),
-													SyntaxFactory::CreateSimpleTemplateIdentifier(
-														SyntaxFactory::CreateUniqueToken(SyntaxTokenType::Identifier, "make_shared"),
-														SyntaxFactory::CreateKeywordToken(SyntaxTokenType::LessThan),
-														SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>(
-															{
-																testClassType,
-															},
-															{}),
-														SyntaxFactory::CreateKeywordToken(SyntaxTokenType::GreaterThan))),
-												SyntaxFactory::CreateKeywordToken(SyntaxTokenType::OpenParenthesis),
-												SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>({}, {}),
-												SyntaxFactory::CreateKeywordToken(SyntaxTokenType::CloseParenthesis)))),
-								},
-								{})),
-						SyntaxFactory::CreateKeywordToken(SyntaxTokenType::Semicolon))),
-				SyntaxFactory::CreateDeclarationStatement(
-					SyntaxFactory::CreateSimpleDeclaration(
-						SyntaxFactory::CreateDeclarationSpecifierSequence(
-							SyntaxFactory::CreateIdentifierType(
-								SyntaxFactory::CreateSimpleIdentifier(
-									SyntaxFactory::CreateUniqueToken(
-										SyntaxTokenType::Identifier,
-										"TestState",
-										{
-											SyntaxFactory::CreateTrivia("\n"),
-											SyntaxFactory::CreateTrivia("	"),
-										},
-										{})))),
-						SyntaxFactory::CreateInitializerDeclaratorList(
-							SyntaxFactory::CreateSyntaxSeparatorList<InitializerDeclarator>(
-								{
-									SyntaxFactory::CreateInitializerDeclarator(
-										SyntaxFactory::CreateSimpleIdentifier(
-											SyntaxFactory::CreateUniqueToken(
-												SyntaxTokenType::Identifier,
-												"state",
-												{
-													SyntaxFactory::CreateTrivia(" "),
-												},
-												{})),
-										SyntaxFactory::CreateValueEqualInitializer(
-											SyntaxFactory::CreateKeywordToken(
-												SyntaxTokenType::Equal,
-												{
-													SyntaxFactory::CreateTrivia(" "),
-												},
-												{}),
-											SyntaxFactory::CreateInitializerList(
-												SyntaxFactory::CreateKeywordToken(
-													SyntaxTokenType::OpenBrace,
-													{
-														SyntaxFactory::CreateTrivia(" "),
-													},
-													{}),
-												SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>(
-													{
-														SyntaxFactory::CreateLiteralExpression(
-															LiteralType::Integer,
-															SyntaxFactory::CreateUniqueToken(
-																SyntaxTokenType::IntegerLiteral,
-																"0",
-																{
-																	SyntaxFactory::CreateTrivia(" "),
-																},
-																{})),
-														SyntaxFactory::CreateLiteralExpression(
-															LiteralType::Integer,
-															SyntaxFactory::CreateUniqueToken(
-																SyntaxTokenType::IntegerLiteral,
-																"0",
-																{
-																	SyntaxFactory::CreateTrivia(" "),
-																},
-																{})),
-													},
-													{
-														SyntaxFactory::CreateKeywordToken(SyntaxTokenType::Comma),
-													}),
-												SyntaxFactory::CreateKeywordToken(
-													SyntaxTokenType::CloseBrace,
-													{
-														SyntaxFactory::CreateTrivia(" "),
-													},
-													{})))),
-								},
-								{})),
-						SyntaxFactory::CreateKeywordToken(SyntaxTokenType::Semicolon))),
-			};
-
-			for (auto& testMethod : testClass.GetTestMethods())
-			{
-				if (testMethod.IsTheory)
-				{
-					for (auto& theory : testMethod.Theories)
-					{
-						// Hack: Create a single argument as a literal from the string
-						auto testNameLiteral = "\"" + testMethod.Name + "(" + EscapeString(theory) + ")\"";
-						auto parameters = SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>(
-							{
-								SyntaxFactory::CreateLiteralExpression(
-									LiteralType::String,
-									SyntaxFactory::CreateUniqueToken(SyntaxTokenType::StringLiteral, theory)),
-							}, 
-							{});
-						auto runTestCall = BuildRunTestCall(
-							testMethod.Name,
-							std::move(testNameLiteral),
-							std::move(parameters));
-						statements.push_back(std::move(runTestCall));
-					}
-				}
-				else
-				{
-					auto testNameLiteral = "\"" + testMethod.Name + "\"";
-					auto parameters = SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>({}, {});
-					auto runTestCall = BuildRunTestCall(
-						testMethod.Name,
-						std::move(testNameLiteral),
-						std::move(parameters));
-					statements.push_back(std::move(runTestCall));
-				}
+				throw std::runtime_error("Verify output text hash matches input source.");
 			}
+		}
 
-			// Add return "return state;"
-			statements.push_back(
-				SyntaxFactory::CreateReturnStatement(
-					SyntaxFactory::CreateKeywordToken(
-						SyntaxTokenType::Return,
-						{
-							SyntaxFactory::CreateTrivia("\n"),
-							SyntaxFactory::CreateTrivia("\n"),
-							SyntaxFactory::CreateTrivia("	"),
-						},
-						{}),
-					SyntaxFactory::CreateIdentifierExpression(
-						SyntaxFactory::CreateSimpleIdentifier(
-							SyntaxFactory::CreateUniqueToken(
-								SyntaxTokenType::Identifier,
-								"state",
-								{
-									SyntaxFactory::CreateTrivia(" "),
-								},
-								{}))),
-					SyntaxFactory::CreateKeywordToken(SyntaxTokenType::Semicolon)));
-
-			// #include "[TEST_FILE]"
-			// TestState Run[TEST_CLASS]()
-			auto testFileInclude = "#include \"" + file + "\"\n";
-			auto testClassRunName = "Run" + testClass.GetName();
-			auto runnerFunction = SyntaxFactory::CreateFunctionDefinition(
-				SyntaxFactory::CreateDeclarationSpecifierSequence(
-					SyntaxFactory::CreateIdentifierType(
-						SyntaxFactory::CreateSimpleIdentifier(
-							SyntaxFactory::CreateUniqueToken(
-								SyntaxTokenType::Identifier,
-								"TestState",
-								{
-									SyntaxFactory::CreateTrivia("#pragma once\n"),
-									SyntaxFactory::CreateTrivia(testFileInclude),
-									SyntaxFactory::CreateTrivia("\n"),
-								},
-								{})))),
-				SyntaxFactory::CreateIdentifierExpression(
-					SyntaxFactory::CreateSimpleIdentifier(
-						SyntaxFactory::CreateUniqueToken(
-							SyntaxTokenType::Identifier,
-							testClassRunName,
-							{
-								SyntaxFactory::CreateTrivia(" "),
-							},
-							{}))),
-				SyntaxFactory::CreateParameterList(
-					SyntaxFactory::CreateKeywordToken(SyntaxTokenType::OpenParenthesis),
-					SyntaxFactory::CreateSyntaxSeparatorList<Parameter>({}, {}),
-					SyntaxFactory::CreateKeywordToken(
-						SyntaxTokenType::CloseParenthesis,
-						{},
-						{
-							SyntaxFactory::CreateTrivia(" "),
-						})),
-				SyntaxFactory::CreateRegularFunctionBody(
-					SyntaxFactory::CreateCompoundStatement(
-						SyntaxFactory::CreateKeywordToken(
-							SyntaxTokenType::OpenBrace,
-							{
-								SyntaxFactory::CreateTrivia("\n"),
-								SyntaxFactory::CreateTrivia(" "),
-							},
-							{}),
-						SyntaxFactory::CreateSyntaxList<Statement>(
-							std::move(statements)),
-						SyntaxFactory::CreateKeywordToken(
-							SyntaxTokenType::CloseBrace,
-							{
-								SyntaxFactory::CreateTrivia("\n"),
-							},
-							{}))));
-
-			return runnerFunction;
-		}
-
-		static std::shared_ptr<const Statement> BuildRunTestCall(
-			const std::string& testName,
-			std::string testNameLiteral,
-			std::shared_ptr<const SyntaxSeparatorList<SyntaxNode>> parameters)
-		{
-			// testClass->[TEST_NAME]([PARAMETERS]);
-			auto testMemberCall = SyntaxFactory::CreateExpressionStatement(
-				SyntaxFactory::CreateInvocationExpression(
-					SyntaxFactory::CreateBinaryExpression(
-						BinaryOperator::MemberOfPointer,
-						SyntaxFactory::CreateIdentifierExpression(
-							SyntaxFactory::CreateSimpleIdentifier(
-								SyntaxFactory::CreateUniqueToken(
-									SyntaxTokenType::Identifier,
-									"testClass",
-									{
-										SyntaxFactory::CreateTrivia(" "),
-									},
-									{}))),
-						SyntaxFactory::CreateKeywordToken(SyntaxTokenType::Arrow),
-						SyntaxFactory::CreateIdentifierExpression(
-							SyntaxFactory::CreateSimpleIdentifier(
-								SyntaxFactory::CreateUniqueToken(SyntaxTokenType::Identifier, testName)))),
-					SyntaxFactory::CreateKeywordToken(SyntaxTokenType::OpenParenthesis),
-					parameters,
-					SyntaxFactory::CreateKeywordToken(SyntaxTokenType::CloseParenthesis)),
-				SyntaxFactory::CreateKeywordToken(SyntaxTokenType::Semicolon));
-
-			// state += RunTest(className, "[TEST_NAME_LITERAL]", [&testClass]() { testClass->[TEST_NAME]([PARAMETERS]); });
-			auto runTestCall = SyntaxFactory::CreateExpressionStatement(
-				SyntaxFactory::CreateBinaryExpression(
-					BinaryOperator::AdditionAssignment,
-					SyntaxFactory::CreateIdentifierExpression(
-						SyntaxFactory::CreateSimpleIdentifier(
-							SyntaxFactory::CreateUniqueToken(
-								SyntaxTokenType::Identifier,
-								"state",
-								{
-									SyntaxFactory::CreateTrivia("\n"),
-									SyntaxFactory::CreateTrivia("	"),
-								},
-								{}))),
-					SyntaxFactory::CreateKeywordToken(
-						SyntaxTokenType::PlusEqual,
-						{
-							SyntaxFactory::CreateTrivia(" "),
-						},
-						{}),
-					SyntaxFactory::CreateInvocationExpression(
-						SyntaxFactory::CreateIdentifierExpression(
-							SyntaxFactory::CreateNestedNameSpecifier(
-								SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>(
-									{
-										SyntaxFactory::CreateSimpleIdentifier(
-											SyntaxFactory::CreateUniqueToken(
-												SyntaxTokenType::Identifier,
-												"SoupTest",
-												{
-													SyntaxFactory::CreateTrivia(" "),
-												},
-												{})),
-									},
-									{
-										SyntaxFactory::CreateKeywordToken(SyntaxTokenType::DoubleColon),
-									})),
-							SyntaxFactory::CreateSimpleIdentifier(
-								SyntaxFactory::CreateUniqueToken(SyntaxTokenType::Identifier, "RunTest"))),
-						SyntaxFactory::CreateKeywordToken(SyntaxTokenType::OpenParenthesis),
-						SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>(
-							{
-								SyntaxFactory::CreateIdentifierExpression(
-									SyntaxFactory::CreateSimpleIdentifier(
-										SyntaxFactory::CreateUniqueToken(SyntaxTokenType::Identifier, "className"))),
-								SyntaxFactory::CreateIdentifierExpression(
-									SyntaxFactory::CreateSimpleIdentifier(
-										SyntaxFactory::CreateUniqueToken(
-											SyntaxTokenType::Identifier,
-											testNameLiteral,
-											{
-												SyntaxFactory::CreateTrivia(" "),
-											},
-											{}))),
-								SyntaxFactory::CreateLambdaExpression(
-									SyntaxFactory::CreateKeywordToken(
-										SyntaxTokenType::OpenBracket,
-										{
-											SyntaxFactory::CreateTrivia(" "),
-										},
-										{}),
-									SyntaxFactory::CreateSyntaxSeparatorList<LambdaCaptureClause>(
-										{
-											SyntaxFactory::CreateLambdaCaptureClause(
-												SyntaxFactory::CreateKeywordToken(SyntaxTokenType::Ampersand),
-												SyntaxFactory::CreateUniqueToken(SyntaxTokenType::Identifier, "testClass")),
-										},
-										{}),
-									SyntaxFactory::CreateKeywordToken(SyntaxTokenType::CloseBracket),
-									SyntaxFactory::CreateParameterList(
-										SyntaxFactory::CreateKeywordToken(SyntaxTokenType::OpenParenthesis),
-										SyntaxFactory::CreateSyntaxSeparatorList<Parameter>({}, {}),
-										SyntaxFactory::CreateKeywordToken(SyntaxTokenType::CloseParenthesis)),
-									SyntaxFactory::CreateCompoundStatement(
-										SyntaxFactory::CreateKeywordToken(
-											SyntaxTokenType::OpenBrace,
-											{
-												SyntaxFactory::CreateTrivia(" "),
-											},
-											{}),
-										SyntaxFactory::CreateSyntaxList<Statement>({
-											testMemberCall,
-										}),
-										SyntaxFactory::CreateKeywordToken(
-											SyntaxTokenType::CloseBrace,
-											{
-												SyntaxFactory::CreateTrivia(" "),
-											},
-											{}))),
-							},
-							{
-								SyntaxFactory::CreateKeywordToken(SyntaxTokenType::Comma),
-								SyntaxFactory::CreateKeywordToken(SyntaxTokenType::Comma),
-							}),
-						SyntaxFactory::CreateKeywordToken(SyntaxTokenType::CloseParenthesis))),
-					SyntaxFactory::CreateKeywordToken(SyntaxTokenType::Semicolon));
-
-			return runTestCall;
-		}
-
-		static std::string EscapeString(const std::string& value)
-		{
-			auto result = std::stringstream();
-			char previousCharacter = 0;
-			for (char character : value)
-			{
-				// If escape character and it isnt already escaped
-				if (character == '\"' && previousCharacter != '\\')
-				{
-					result << '\\';
-				}
+		static void VerifyResult(
+			const std::shared_ptr<const SyntaxTree>& syntaxTree,
+			std::string_view source,
+			std::ostream& log)
+		{
+			// Verifiy we can handle this file by streaming the output against the source,
+			// the compare fails the stream at the first difference so the rest of the write is skipped
+			auto compareBuffer = CompareStreamBuffer(source);
+			auto output = std::ostream(&compareBuffer);
+			syntaxTree->Write(output);
 
-				result << character;
-				previousCharacter = character;
+			if (!compareBuffer.IsMatch())
+			{
+				auto offset = compareBuffer.GetMismatchOffset();
+				auto contextStart = offset - std::min<size_t>(offset, 40);
+				log << "Mismatch at offset " << offset << ": " << source.substr(contextStart, 80) << "\n";
+				throw std::runtime_error("Verify output text matches input source.");
 			}
-
-			return result.str();
 		}
+
 	};
 }
@@ -0,0 +1,179 @@
+﻿// <copyright file="stream-buffers.h" company="Soup">
+// Copyright (c) Soup. All rights reserved.
+// </copyright>
+
+#pragma once
+
+namespace Soup::Test
+{
+	/// <summary>
+	/// An input stream buffer that reads directly from an existing block of memory without copying it
+	/// </summary>
+	class MemoryStreamBuffer : public std::streambuf
+	{
+	public:
+		MemoryStreamBuffer(std::string_view content)
+		{
+			auto begin = const_cast<char*>(content.data());
+			setg(begin, begin, begin + content.size());
+		}
+
+	protected:
+		pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode which) override
+		{
+			if (!(which & std::ios_base::in))
+				return pos_type(off_type(-1));
+
+			off_type base = 0;
+			if (direction == std::ios_base::cur)
+				base = gptr() - eback();
+			else if (direction == std::ios_base::end)
+				base = egptr() - eback();
+
+			return seekpos(pos_type(base + offset), which);
+		}
+
+		pos_type seekpos(pos_type position, std::ios_base::openmode which) override
+		{
+			auto offset = off_type(position);
+			if (!(which & std::ios_base::in) || offset < 0 || offset > egptr() - eback())
+				return pos_type(off_type(-1));
+
+			setg(eback(), eback() + offset, egptr());
+			return position;
+		}
+	};
+
+	/// <summary>
+	/// An output stream buffer that compares everything written against the expected content
+	/// and fails the stream at the first mismatch so the remaining writes are skipped
+	/// </summary>
+	class CompareStreamBuffer : public std::streambuf
+	{
+	public:
+		CompareStreamBuffer(std::string_view expected) :
+			m_expected(expected),
+			m_position(0),
+			m_hasMismatch(false)
+		{
+		}
+
+		/// <summary>
+		/// Check if the written content exactly matched the expected content
+		/// </summary>
+		bool IsMatch() const
+		{
+			return !m_hasMismatch && m_position == m_expected.size();
+		}
+
+		/// <summary>
+		/// The offset of the first difference, which is the expected size if the output was truncated
+		/// </summary>
+		size_t GetMismatchOffset() const
+		{
+			return m_position;
+		}
+
+	protected:
+		int_type overflow(int_type value) override
+		{
+			if (traits_type::eq_int_type(value, traits_type::eof()))
+				return traits_type::not_eof(value);
+
+			auto character = traits_type::to_char_type(value);
+			return xsputn(&character, 1) == 1 ? value : traits_type::eof();
+		}
+
+		std::streamsize xsputn(const char* data, std::streamsize count) override
+		{
+			if (m_hasMismatch)
+				return 0;
+
+			auto remaining = m_expected.size() - m_position;
+			auto compareCount = std::min(static_cast<size_t>(count), remaining);
+			auto expected = m_expected.data() + m_position;
+			auto mismatch = std::mismatch(data, data + compareCount, expected);
+			m_position += static_cast<size_t>(mismatch.first - data);
+			if (mismatch.first != data + count)
+			{
+				m_hasMismatch = true;
+				return mismatch.first - data;
+			}
+
+			return count;
+		}
+
+	private:
+		std::string_view m_expected;
+		size_t m_position;
+		bool m_hasMismatch;
+	};
+
+	/// <summary>
+	/// An output stream buffer that hashes everything written without storing it
+	/// </summary>
+	class HashStreamBuffer : public std::streambuf
+	{
+	public:
+		HashStreamBuffer() :
+			m_hash(GenerationCache::InitialHash)
+		{
+		}
+
+		uint64_t GetHash() const
+		{
+			return m_hash;
+		}
+
+	protected:
+		int_type overflow(int_type value) override
+		{
+			if (traits_type::eq_int_type(value, traits_type::eof()))
+				return traits_type::not_eof(value);
+
+			auto character = traits_type::to_char_type(value);
+			m_hash = GenerationCache::HashContent(std::string_view(&character, 1), m_hash);
+			return value;
+		}
+
+		std::streamsize xsputn(const char* data, std::streamsize count) override
+		{
+			m_hash = GenerationCache::HashContent(std::string_view(data, static_cast<size_t>(count)), m_hash);
+			return count;
+		}
+
+	private:
+		uint64_t m_hash;
+	};
+
+	/// <summary>
+	/// An output stream buffer that appends everything written to an existing string
+	/// </summary>
+	class StringStreamBuffer : public std::streambuf
+	{
+	public:
+		StringStreamBuffer(std::string& output) :
+			m_output(output)
+		{
+		}
+
+	protected:
+		int_type overflow(int_type value) override
+		{
+			if (traits_type::eq_int_type(value, traits_type::eof()))
+				return traits_type::not_eof(value);
+
+			m_output.push_back(traits_type::to_char_type(value));
+			return value;
+		}
+
+		std::streamsize xsputn(const char* data, std::streamsize count) override
+		{
+			m_output.append(data, static_cast<size_t>(count));
+			return count;
+		}
+
+	private:
+		std::string& m_output;
+	};
+}
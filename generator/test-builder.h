@@ -8,42 +8,55 @@ using namespace Soup::Syntax;
 
 namespace Soup::Test
 {
+	/// <summary>
+	/// The source text of each argument in a single [[InlineData]] row
+	/// </summary>
+	using TheoryArguments = std::vector<std::string>;
+
 	struct TestMethod
 	{
 		TestMethod(
 			bool isTheory,
-			std::string name,
-			std::vector<std::string> theories) :
+			bool isBenchmark,
+			std::string_view name,
+			std::vector<TheoryArguments> theories,
+			uint32_t timeoutMilliseconds) :
 			IsTheory(isTheory),
-			Name(std::move(name)),
-			Theories(std::move(theories))
+			IsBenchmark(isBenchmark),
+			Name(name),
+			Theories(std::move(theories)),
+			TimeoutMilliseconds(timeoutMilliseconds)
 		{
 		}
 
 		bool IsTheory;
-		std::string Name;
-		std::vector<std::string> Theories;
+		bool IsBenchmark;
+		std::string_view Name;
+		std::vector<TheoryArguments> Theories;
+
+		// Zero leaves the timeout to the harness
+		uint32_t TimeoutMilliseconds;
 	};
 
 	/// <summary>
-	/// A test class container
+	/// A test class container, the names refer into the syntax tree it was built from
 	/// </summary>
 	class TestClass
 	{
 	public:
-		TestClass(std::string name, std::vector<std::string> qualifiers) :
-			m_name(std::move(name)),
+		TestClass(std::string_view name, std::vector<std::string_view> qualifiers) :
+			m_name(name),
 			m_qualifiers(std::move(qualifiers)),
 			m_testMethods()
 		{
 		}
 
-		const std::string& GetName() const
+		std::string_view GetName() const
 		{
 			return m_name;
 		}
 
-		const std::vector<std::string>& GetQualifiers() const
+		const std::vector<std::string_view>& GetQualifiers() const
 		{
 			return m_qualifiers;
 		}
@@ -59,37 +72,63 @@ namespace Soup::Test
 		}
 
 	private:
-		std::string m_name;
-		std::vector<std::string> m_qualifiers;
+		std::string_view m_name;
+		std::vector<std::string_view> m_qualifiers;
 		std::vector<TestMethod> m_testMethods;
 	};
 
 	/// <summary>
-	/// Syntax Visitor used to find all test methods
+	/// Syntax Visitor used to find all test methods.
+	/// The syntax tree must outlive the builder since all names are views into its tokens.
+	/// Problems with the attributes are written to the log of the file being processed.
 	/// </summary>
 	class TestBuilder : public SyntaxWalker
 	{
 	public:
-		TestBuilder()
+		TestBuilder(std::ostream& log) :
+			m_log(log),
+			m_hasErrors(false),
+			m_testClasses(),
+			m_testClassLookup(),
+			m_inlineData(),
+			m_theoryContent(),
+			m_theoryBuffer(m_theoryContent),
+			m_theoryStream(&m_theoryBuffer)
 		{
 		}
 
-		const std::map<std::string, TestClass>& GetTestClasses()
+		/// <summary>
+		/// The test classes in the order they first appear in the source
+		/// </summary>
+		const std::vector<TestClass>& GetTestClasses() const
 		{
 			return m_testClasses;
 		}
 
+		/// <summary>
+		/// Whether an error was written to the log, the file still produces a runner for everything else
+		/// </summary>
+		bool HasErrors() const
+		{
+			return m_hasErrors;
+		}
+
 	protected:
 		virtual void Visit(const OuterTree::FunctionDefinition& node) override final
 		{
-			// Check if the function has a parent class
-			if (IsFact(node))
+			// Classify every attribute in a single pass
+			auto attributes = ClassifyAttributes(node);
+			if (attributes.IsFact)
 			{
-				AddTestMethod(node, false);
+				AddTestMethod(node, false, false, attributes);
 			}
-			else if (IsTheory(node))
+			else if (attributes.IsTheory)
 			{
-				AddTestMethod(node, true);
+				AddTestMethod(node, true, false, attributes);
+			}
+			else if (attributes.IsBenchmark)
+			{
+				AddTestMethod(node, false, true, attributes);
 			}
 
 			// Call base implementation
@@ -97,128 +136,194 @@ namespace Soup::Test
 		}
 
 	private:
+		/// <summary>
+		/// The test related attributes on a single function
+		/// </summary>
+		struct FunctionAttributes
+		{
+			bool IsFact = false;
+			bool IsTheory = false;
+			bool IsBenchmark = false;
+			const OuterTree::Attribute* Timeout = nullptr;
+		};
+
+		FunctionAttributes ClassifyAttributes(const OuterTree::FunctionDefinition& function)
+		{
+			// The inline data rows are kept aside so a theory does not need a second walk
+			m_inlineData.clear();
+
+			auto result = FunctionAttributes();
+			for (auto& specifier : function.GetAttributeSpecifierSequence().GetItems())
+			{
+				auto& attributes = specifier->GetAttributes().GetItems();
+				if (attributes.size() == 1)
+				{
+					auto& attribute = attributes.front();
+					auto& value = attribute->GetIdentifierToken().GetValue();
+					if (value == "Fact")
+					{
+						result.IsFact = true;
+					}
+					else if (value == "Theory")
+					{
+						result.IsTheory = true;
+					}
+					else if (value == "Benchmark")
+					{
+						result.IsBenchmark = true;
+					}
+					else if (value == "Timeout")
+					{
+						result.Timeout = attribute.get();
+					}
+					else if (value == "InlineData")
+					{
+						m_inlineData.push_back(attribute.get());
+					}
+				}
+			}
+
+			return result;
+		}
+
 		// Check if the privided function has a fact attribute
-		void AddTestMethod(const OuterTree::FunctionDefinition& function, bool isTheory)
+		void AddTestMethod(
+			const OuterTree::FunctionDefinition& function,
+			bool isTheory,
+			bool isBenchmark,
+			const FunctionAttributes& attributes)
 		{
+			// If this is a theory then load of all of the inline data
+			std::vector<TheoryArguments> theories = {};
+			if (isTheory)
+			{
+				theories.reserve(m_inlineData.size());
+				for (auto attribute : m_inlineData)
+				{
+					if (!attribute->HasArgumentClause())
+					{
+						m_log << "ERROR: Must have arguments to theory." << "\n";
+						m_hasErrors = true;
+						continue;
+					}
+
+					theories.push_back(GetArguments(*attribute));
+				}
+
+				// A theory without data has nothing to run
+				if (theories.empty())
+					return;
+			}
+
+			// [[Timeout(MILLISECONDS)]]
+			uint32_t timeoutMilliseconds = 0;
+			if (attributes.Timeout != nullptr)
+				timeoutMilliseconds = GetTimeout(*attributes.Timeout);
+
 			// Get the parent class name
 			auto& parentClass = dynamic_cast<const OuterTree::ClassSpecifier&>(function.GetParent());
 			if (!parentClass.HasIdentifierToken())
 				throw std::runtime_error("A test class must have a name.");
-			auto& parentClassName = parentClass.GetIdentifierToken().GetValue();
+			std::string_view parentClassName = parentClass.GetIdentifierToken().GetValue();
 
 			// Ensure that the class is registered
-			auto classEntry = m_testClasses.find(parentClassName);
-			if (classEntry == m_testClasses.end())
+			auto classEntry = m_testClassLookup.find(parentClassName);
+			if (classEntry == m_testClassLookup.end())
 			{
 				// Build up the namespace for the class
-				std::vector<std::string> qualifiers = GetContainingQualfiers(parentClass);
+				auto qualifiers = GetContainingQualfiers(parentClass);
 
 				// Add the new class
-				auto insertResult = m_testClasses.emplace(
-					parentClassName,
-					TestClass(parentClassName, std::move(qualifiers)));
+				m_testClasses.push_back(TestClass(parentClassName, std::move(qualifiers)));
+				classEntry = m_testClassLookup.emplace(parentClassName, m_testClasses.size() - 1).first;
 			}
 
-			auto& testClass = m_testClasses.at(parentClassName);
+			auto& testClass = m_testClasses[classEntry->second];
 
 			// Get the method name
-			auto& methodName = dynamic_cast<const OuterTree::SimpleIdentifier&>(
+			std::string_view methodName = dynamic_cast<const OuterTree::SimpleIdentifier&>(
 				function.GetIdentifier().GetUnqualifiedIdentifier())
 					.GetIdentifierToken().GetValue();
 
-			// If this is a theory then load of all of the inline data
-			std::vector<std::string> theories = {};
-			if (isTheory)
-			{
-				theories = GetTheories(function);
-			}
-
 			// Register the method name
 			testClass.GetTestMethods().push_back(
-				TestMethod(isTheory, methodName, std::move(theories)));
+				TestMethod(isTheory, isBenchmark, methodName, std::move(theories), timeoutMilliseconds));
 		}
 
-		// Check if the privided function has a fact attribute
-		bool IsFact(const OuterTree::FunctionDefinition& function)
+		uint32_t GetTimeout(const OuterTree::Attribute& attribute)
 		{
-			auto& attributeSpecifiers = function.GetAttributeSpecifierSequence().GetItems();
-			for (auto& specifier : attributeSpecifiers)
+			auto arguments = attribute.HasArgumentClause() ? GetArguments(attribute) : TheoryArguments();
+			uint32_t result = 0;
+			if (arguments.size() == 1)
 			{
-				auto attributes = specifier->GetAttributes().GetItems();
-				if (attributes.size() == 1)
-				{
-					auto& attribute = attributes.at(0);
-					auto& value = attribute->GetIdentifierToken().GetValue();
-					if (value == "Fact")
-					{
-						return true;
-					}
-				}
+				auto& value = arguments.front();
+				auto parseResult = std::from_chars(value.data(), value.data() + value.size(), result);
+				if (parseResult.ec == std::errc() && parseResult.ptr == value.data() + value.size() && result > 0)
+					return result;
 			}
 
-			return false;
+			m_log << "ERROR: Timeout must be a positive number of milliseconds." << "\n";
+			m_hasErrors = true;
+			return 0;
 		}
 
-		// Check if the privided function has a theory attribute
-		bool IsTheory(const OuterTree::FunctionDefinition& function)
+		/// <summary>
+		/// Split the argument clause at the top level commas, keeping the source text of each argument
+		/// </summary>
+		TheoryArguments GetArguments(const OuterTree::Attribute& attribute)
 		{
-			auto& attributeSpecifiers = function.GetAttributeSpecifierSequence().GetItems();
-			for (auto& specifier : attributeSpecifiers)
+			auto arguments = TheoryArguments();
+			int nestingDepth = 0;
+			m_theoryContent.clear();
+			for (auto& token : attribute.GetArgumentClause().GetTokens().GetItems())
 			{
-				auto attributes = specifier->GetAttributes().GetItems();
-				if (attributes.size() == 1)
+				auto& value = token->GetValue();
+				if (value == "(" || value == "[" || value == "{")
 				{
-					auto& attribute = attributes.at(0);
-					auto& value = attribute->GetIdentifierToken().GetValue();
-					if (value == "Theory")
-					{
-						return true;
-					}
+					nestingDepth++;
+				}
+				else if (value == ")" || value == "]" || value == "}")
+				{
+					nestingDepth--;
+				}
+				else if (value == "," && nestingDepth == 0)
+				{
+					arguments.push_back(TrimArgument(m_theoryContent));
+					m_theoryContent.clear();
+					continue;
 				}
+
+				token->Write(m_theoryStream);
 			}
 
-			return false;
+			arguments.push_back(TrimArgument(m_theoryContent));
+
+			// An empty clause is a row with no arguments
+			if (arguments.size() == 1 && arguments.front().empty())
+				arguments.clear();
+
+			return arguments;
 		}
 
-		std::vector<std::string> GetTheories(const OuterTree::FunctionDefinition& function)
+		static std::string TrimArgument(std::string_view value)
 		{
-			std::vector<std::string> theories = {};
-			auto& attributeSpecifiers = function.GetAttributeSpecifierSequence().GetItems();
-			for (auto& specifier : attributeSpecifiers)
-			{
-				auto attributes = specifier->GetAttributes().GetItems();
-				if (attributes.size() == 1)
-				{
-					auto& attribute = attributes.at(0);
-					auto& value = attribute->GetIdentifierToken().GetValue();
-					if (value == "InlineData")
-					{
-						if (!attribute->HasArgumentClause())
-						{
-							std::cout << "ERROR: Must have arguments to theory." << std::endl;
-							continue;
-						}
-
-						// Combine everything into a big string 
-						// TODO: We need to parse this for realz
-						auto& arguments = attribute->GetArgumentClause();
-						std::stringstream stringBuilder;
-						for (auto& token : arguments.GetTokens().GetItems())
-						{
-							token->Write(stringBuilder);
-						}
-
-						theories.push_back(stringBuilder.str());
-					}
-				}
-			}
+			constexpr std::string_view Whitespace = " \t\r\n";
+			auto start = value.find_first_not_of(Whitespace);
+			if (start == std::string_view::npos)
+				return std::string();
 
-			return theories;
+			auto end = value.find_last_not_of(Whitespace);
+			return std::string(value.substr(start, end - start + 1));
 		}
 
-		std::vector<std::string> GetContainingQualfiers(const OuterTree::SyntaxNode& node)
+		/// <summary>
+		/// Gather the namespace of a class from the outermost block in.
+		/// The walk visits the innermost block first, so the names of each block are placed ahead of the
+		/// names already gathered while keeping their source order within a qualified block.
+		/// </summary>
+		std::vector<std::string_view> GetContainingQualfiers(const OuterTree::SyntaxNode& node)
 		{
-			std::vector<std::string> qualifiers = {};
+			std::vector<std::string_view> qualifiers = {};
 			const OuterTree::SyntaxNode* currentNode = &node;
 			while (currentNode->HasParent())
 			{
@@ -226,9 +331,11 @@ namespace Soup::Test
 				if (currentNode->GetType() == SyntaxNodeType::NamespaceDefinition)
 				{
 					auto& namespaceDefinition = dynamic_cast<const OuterTree::NamespaceDefinition&>(*currentNode);
-					for (auto& identifier : namespaceDefinition.GetNameIdentifierList().GetItems())
+					auto& identifiers = namespaceDefinition.GetNameIdentifierList().GetItems();
+					qualifiers.insert(qualifiers.begin(), identifiers.size(), std::string_view());
+					for (size_t i = 0; i < identifiers.size(); i++)
 					{
-						qualifiers.push_back(identifier->GetValue());
+						qualifiers[i] = identifiers[i]->GetValue();
 					}
 				}
 
@@ -239,6 +346,13 @@ namespace Soup::Test
 		}
 
 	private:
-		std::map<std::string, TestClass> m_testClasses;
+		std::ostream& m_log;
+		bool m_hasErrors;
+		std::vector<TestClass> m_testClasses;
+		std::unordered_map<std::string_view, size_t> m_testClassLookup;
+		std::vector<const OuterTree::Attribute*> m_inlineData;
+		std::string m_theoryContent;
+		StringStreamBuffer m_theoryBuffer;
+		std::ostream m_theoryStream;
 	};
 }
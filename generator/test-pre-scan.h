@@ -0,0 +1,106 @@
+﻿// <copyright file="test-pre-scan.h" company="Soup">
+// Copyright (c) Soup. All rights reserved.
+// </copyright>
+
+#pragma once
+
+namespace Soup::Test
+{
+	/// <summary>
+	/// A conservative byte level scan that rejects files that cannot contain a test method
+	/// before paying for a full parse. A test requires a [[Fact]], [[Theory]] or [[Benchmark]] attribute,
+	/// so the scan looks for each "[[" attribute opener and checks the identifiers up to the matching "]]".
+	/// [[InlineData]] rows are only meaningful on a theory so they do not keep a file alive on their own.
+	/// </summary>
+	class TestPreScan
+	{
+	public:
+		static bool MayContainTests(std::string_view source)
+		{
+			size_t offset = 0;
+			while (true)
+			{
+				auto attributeStart = FindPair(source, offset, '[', '[');
+				if (attributeStart == std::string_view::npos)
+					return false;
+
+				auto contentStart = attributeStart + 2;
+				auto attributeEnd = FindPair(source, contentStart, ']', ']');
+				if (attributeEnd == std::string_view::npos)
+					attributeEnd = source.size();
+
+				if (HasTestIdentifier(source.substr(contentStart, attributeEnd - contentStart)))
+					return true;
+
+				offset = contentStart;
+			}
+		}
+
+	private:
+		/// <summary>
+		/// Find the next position of the two character sequence, sixteen candidate positions at a time when SSE2 is available
+		/// </summary>
+		static size_t FindPair(std::string_view source, size_t offset, char first, char second)
+		{
+			auto data = source.data();
+			auto size = source.size();
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+			auto firstPattern = _mm_set1_epi8(first);
+			auto secondPattern = _mm_set1_epi8(second);
+			while (offset + 16 < size)
+			{
+				auto current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset));
+				auto next = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset + 1));
+				auto matches = _mm_and_si128(
+					_mm_cmpeq_epi8(current, firstPattern),
+					_mm_cmpeq_epi8(next, secondPattern));
+				auto mask = static_cast<unsigned int>(_mm_movemask_epi8(matches));
+				if (mask != 0)
+					return offset + std::countr_zero(mask);
+
+				offset += 16;
+			}
+#endif
+
+			for (; offset + 1 < size; offset++)
+			{
+				if (data[offset] == first && data[offset + 1] == second)
+					return offset;
+			}
+
+			return std::string_view::npos;
+		}
+
+		static bool HasTestIdentifier(std::string_view attributeContent)
+		{
+			size_t offset = 0;
+			while (offset < attributeContent.size())
+			{
+				if (!IsIdentifierCharacter(attributeContent[offset]))
+				{
+					offset++;
+					continue;
+				}
+
+				auto identifierStart = offset;
+				while (offset < attributeContent.size() && IsIdentifierCharacter(attributeContent[offset]))
+					offset++;
+
+				auto identifier = attributeContent.substr(identifierStart, offset - identifierStart);
+				if (identifier == "Fact" || identifier == "Theory" || identifier == "Benchmark")
+					return true;
+			}
+
+			return false;
+		}
+
+		static bool IsIdentifierCharacter(char value)
+		{
+			return (value >= 'a' && value <= 'z') ||
+				(value >= 'A' && value <= 'Z') ||
+				(value >= '0' && value <= '9') ||
+				value == '_';
+		}
+	};
+}
@@ -0,0 +1,752 @@
+﻿// <copyright file="test-runner-syntax-builder.h" company="Soup">
+// Copyright (c) Soup. All rights reserved.
+// </copyright>
+
+#pragma once
+
+using namespace Soup::Syntax;
+using namespace Soup::Syntax::InnerTree;
+
+namespace Soup::Test
+{
+	/// <summary>
+	/// The reference test runner emitter that builds the runner as a syntax tree through the SyntaxFactory
+	/// </summary>
+	class TestRunnerSyntaxBuilder
+	{
+	public:
+		static std::shared_ptr<const SyntaxTree> BuildTestRunner(
+			const TestBuilder& testBuilder,
+			const std::string& file,
+			std::string_view moduleName)
+		{
+			// Hack: The preprocessor directives and module declarations are carried as trivia
+			auto isModule = !moduleName.empty();
+			auto fileHeader = std::string();
+			if (isModule)
+			{
+				// export module [TEST_MODULE].TestRunner;
+				// import Soup.Test.Assert;
+				// import [TEST_MODULE];
+				fileHeader = "export module " + std::string(moduleName) + ".TestRunner;\n" +
+					"import Soup.Test.Assert;\n" +
+					"import " + std::string(moduleName) + ";\n\n" +
+					"namespace SoupTest = Soup::Test;\n" +
+					"using Soup::Test::TestState;\n";
+			}
+			else
+			{
+				// #pragma once
+				// #include "[TEST_FILE]"
+				fileHeader = "#pragma once\n#include \"" + file + "\"\n";
+			}
+
+			// Build up the test runner
+			std::vector<std::shared_ptr<const Declaration>> declarations = {};
+			for (auto& testClass : testBuilder.GetTestClasses())
+			{
+				declarations.push_back(BuildTestTableFunction(testClass, std::exchange(fileHeader, std::string()), isModule));
+				declarations.push_back(BuildTestRunnerFunction(testClass, isModule));
+			}
+
+			auto translationUnit = SyntaxFactory::CreateTranslationUnit(
+				SyntaxFactory::CreateSyntaxList<Declaration>(std::move(declarations)),
+				SyntaxFactory::CreateKeywordToken(SyntaxTokenType::EndOfFile));
+
+			return std::make_shared<const SyntaxTree>(
+				std::move(translationUnit));
+		}
+
+	private:
+		static std::shared_ptr<const Declaration> BuildTestTableFunction(
+			const TestClass& testClass,
+			std::string fileHeader,
+			bool isExported)
+		{
+			// { "[CLASS_TYPE]", SoupTest::CreateTestClass<[CLASS_TYPE]>, SoupTest::DestroyTestClass<[CLASS_TYPE]>, SoupTest::TestClassExecution<[CLASS_TYPE]>, SoupTest::TestClassCollectionFixtures<[CLASS_TYPE]> },
+			// The name is qualified so the harness can filter on the namespace
+			std::string classNameLiteral = "\"";
+			for (auto& qualifier : testClass.GetQualifiers())
+			{
+				classNameLiteral += qualifier;
+				classNameLiteral += "::";
+			}
+
+			classNameLiteral += testClass.GetName();
+			classNameLiteral += "\"";
+			auto classDescriptor = SyntaxFactory::CreateInitializerList(
+				CreateKeyword(SyntaxTokenType::OpenBrace, "\n\t\t"),
+				SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>(
+					{
+						SyntaxFactory::CreateLiteralExpression(
+							LiteralType::String,
+							CreateToken(SyntaxTokenType::StringLiteral, classNameLiteral, " ")),
+						SyntaxFactory::CreateIdentifierExpression(
+							BuildSoupTestQualifier(" "),
+							SyntaxFactory::CreateSimpleTemplateIdentifier(
+								CreateToken(SyntaxTokenType::Identifier, "CreateTestClass"),
+								CreateKeyword(SyntaxTokenType::LessThan),
+								SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>(
+									{
+										BuildClassType(testClass),
+									},
+									{}),
+								CreateKeyword(SyntaxTokenType::GreaterThan))),
+						SyntaxFactory::CreateIdentifierExpression(
+							BuildSoupTestQualifier(" "),
+							SyntaxFactory::CreateSimpleTemplateIdentifier(
+								CreateToken(SyntaxTokenType::Identifier, "DestroyTestClass"),
+								CreateKeyword(SyntaxTokenType::LessThan),
+								SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>(
+									{
+										BuildClassType(testClass),
+									},
+									{}),
+								CreateKeyword(SyntaxTokenType::GreaterThan))),
+						SyntaxFactory::CreateIdentifierExpression(
+							BuildSoupTestQualifier(" "),
+							SyntaxFactory::CreateSimpleTemplateIdentifier(
+								CreateToken(SyntaxTokenType::Identifier, "TestClassExecution"),
+								CreateKeyword(SyntaxTokenType::LessThan),
+								SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>(
+									{
+										BuildClassType(testClass),
+									},
+									{}),
+								CreateKeyword(SyntaxTokenType::GreaterThan))),
+						SyntaxFactory::CreateIdentifierExpression(
+							BuildSoupTestQualifier(" "),
+							SyntaxFactory::CreateSimpleTemplateIdentifier(
+								CreateToken(SyntaxTokenType::Identifier, "TestClassCollectionFixtures"),
+								CreateKeyword(SyntaxTokenType::LessThan),
+								SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>(
+									{
+										BuildClassType(testClass),
+									},
+									{}),
+								CreateKeyword(SyntaxTokenType::GreaterThan))),
+					},
+					{
+						CreateKeyword(SyntaxTokenType::Comma),
+						CreateKeyword(SyntaxTokenType::Comma),
+						CreateKeyword(SyntaxTokenType::Comma),
+						CreateKeyword(SyntaxTokenType::Comma),
+					}),
+				CreateKeyword(SyntaxTokenType::CloseBrace, " "));
+
+			// The class table, followed by the row tables of every theory
+			std::vector<std::shared_ptr<const Statement>> statements = {};
+			statements.push_back(
+				BuildStaticTableDeclaration(
+					"static constexpr",
+					SyntaxFactory::CreateSimpleIdentifier(
+						CreateToken(SyntaxTokenType::Identifier, "TestClassDescriptor")),
+					"testClasses",
+					{ classDescriptor }));
+			for (auto& testMethod : testClass.GetTestMethods())
+			{
+				if (testMethod.IsTheory)
+				{
+					BuildTheoryRows(testClass, testMethod, statements);
+				}
+			}
+
+			// { "[TEST_NAME]", 0, [THUNK], [ROW_NAMES][, IS_BENCHMARK[, TIMEOUT]] },
+			std::vector<std::shared_ptr<const SyntaxNode>> testDescriptors = {};
+			for (auto& testMethod : testClass.GetTestMethods())
+			{
+				testDescriptors.push_back(BuildTestDescriptor(testClass, testMethod));
+			}
+
+			statements.push_back(
+				BuildStaticTableDeclaration(
+					"static constexpr",
+					SyntaxFactory::CreateSimpleIdentifier(
+						CreateToken(SyntaxTokenType::Identifier, "TestDescriptor")),
+					"tests",
+					std::move(testDescriptors)));
+
+			// return { testClasses, tests };
+			auto returnStatement = SyntaxFactory::CreateReturnStatement(
+				CreateKeyword(SyntaxTokenType::Return, "\n\n\t"),
+				SyntaxFactory::CreateInitializerList(
+					CreateKeyword(SyntaxTokenType::OpenBrace, " "),
+					SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>(
+						{
+							SyntaxFactory::CreateIdentifierExpression(
+								SyntaxFactory::CreateSimpleIdentifier(
+									CreateToken(SyntaxTokenType::Identifier, "testClasses", " "))),
+							SyntaxFactory::CreateIdentifierExpression(
+								SyntaxFactory::CreateSimpleIdentifier(
+									CreateToken(SyntaxTokenType::Identifier, "tests", " "))),
+						},
+						{
+							CreateKeyword(SyntaxTokenType::Comma),
+						}),
+					CreateKeyword(SyntaxTokenType::CloseBrace, " ")),
+				CreateKeyword(SyntaxTokenType::Semicolon));
+			statements.push_back(returnStatement);
+
+			// [export] SoupTest::TestTable Get[TEST_CLASS]Tests()
+			// Hack: The export keyword is carried as trivia
+			auto testTableFunctionName = "Get" + std::string(testClass.GetName()) + "Tests";
+			return SyntaxFactory::CreateFunctionDefinition(
+				SyntaxFactory::CreateDeclarationSpecifierSequence(
+					SyntaxFactory::CreateIdentifierType(
+						BuildSoupTestQualifier(fileHeader + (isExported ? "\nexport " : "\n")),
+						SyntaxFactory::CreateSimpleIdentifier(
+							CreateToken(SyntaxTokenType::Identifier, "TestTable")))),
+				SyntaxFactory::CreateIdentifierExpression(
+					SyntaxFactory::CreateSimpleIdentifier(
+						CreateToken(SyntaxTokenType::Identifier, testTableFunctionName, " "))),
+				SyntaxFactory::CreateParameterList(
+					CreateKeyword(SyntaxTokenType::OpenParenthesis),
+					SyntaxFactory::CreateSyntaxSeparatorList<Parameter>({}, {}),
+					CreateKeyword(SyntaxTokenType::CloseParenthesis)),
+				SyntaxFactory::CreateRegularFunctionBody(
+					SyntaxFactory::CreateCompoundStatement(
+						CreateKeyword(SyntaxTokenType::OpenBrace, "\n"),
+						SyntaxFactory::CreateSyntaxList<Statement>(std::move(statements)),
+						CreateKeyword(SyntaxTokenType::CloseBrace, "\n"))));
+		}
+
+		static std::shared_ptr<const Declaration> BuildTestRunnerFunction(
+			const TestClass& testClass,
+			bool isExported)
+		{
+			// [export] TestState Run[TEST_CLASS]()
+			// {
+			//	return SoupTest::RunTests(Get[TEST_CLASS]Tests());
+			// }
+			auto testTableFunctionName = "Get" + std::string(testClass.GetName()) + "Tests";
+			auto testClassRunName = "Run" + std::string(testClass.GetName());
+
+			// Hack: The export keyword is carried as trivia
+			auto returnTypeLeadingTrivia = isExported ? "\n\nexport " : "\n\n";
+			return SyntaxFactory::CreateFunctionDefinition(
+				SyntaxFactory::CreateDeclarationSpecifierSequence(
+					SyntaxFactory::CreateIdentifierType(
+						SyntaxFactory::CreateSimpleIdentifier(
+							CreateToken(SyntaxTokenType::Identifier, "TestState", returnTypeLeadingTrivia)))),
+				SyntaxFactory::CreateIdentifierExpression(
+					SyntaxFactory::CreateSimpleIdentifier(
+						CreateToken(SyntaxTokenType::Identifier, testClassRunName, " "))),
+				SyntaxFactory::CreateParameterList(
+					CreateKeyword(SyntaxTokenType::OpenParenthesis),
+					SyntaxFactory::CreateSyntaxSeparatorList<Parameter>({}, {}),
+					CreateKeyword(SyntaxTokenType::CloseParenthesis)),
+				SyntaxFactory::CreateRegularFunctionBody(
+					SyntaxFactory::CreateCompoundStatement(
+						CreateKeyword(SyntaxTokenType::OpenBrace, "\n"),
+						SyntaxFactory::CreateSyntaxList<Statement>(
+							{
+								SyntaxFactory::CreateReturnStatement(
+									CreateKeyword(SyntaxTokenType::Return, "\n\t"),
+									SyntaxFactory::CreateInvocationExpression(
+										SyntaxFactory::CreateIdentifierExpression(
+											BuildSoupTestQualifier(" "),
+											SyntaxFactory::CreateSimpleIdentifier(
+												CreateToken(SyntaxTokenType::Identifier, "RunTests"))),
+										CreateKeyword(SyntaxTokenType::OpenParenthesis),
+										SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>(
+											{
+												SyntaxFactory::CreateInvocationExpression(
+													SyntaxFactory::CreateIdentifierExpression(
+														SyntaxFactory::CreateSimpleIdentifier(
+															CreateToken(SyntaxTokenType::Identifier, testTableFunctionName))),
+													CreateKeyword(SyntaxTokenType::OpenParenthesis),
+													SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>({}, {}),
+													CreateKeyword(SyntaxTokenType::CloseParenthesis)),
+											},
+											{}),
+										CreateKeyword(SyntaxTokenType::CloseParenthesis)),
+									CreateKeyword(SyntaxTokenType::Semicolon)),
+							}),
+						CreateKeyword(SyntaxTokenType::CloseBrace, "\n", "\n"))));
+		}
+
+		static void BuildTheoryRows(
+			const TestClass& testClass,
+			const TestMethod& testMethod,
+			std::vector<std::shared_ptr<const Statement>>& statements)
+		{
+			// { [ARGUMENTS] },
+			std::vector<std::shared_ptr<const SyntaxNode>> rows = {};
+			std::vector<std::shared_ptr<const SyntaxNode>> rowNames = {};
+			for (auto& theory : testMethod.Theories)
+			{
+				// Hack: Create each argument as a literal from its source text
+				std::vector<std::shared_ptr<const SyntaxNode>> arguments = {};
+				std::vector<std::shared_ptr<const SyntaxToken>> argumentSeparators = {};
+				for (auto& argument : theory)
+				{
+					if (!arguments.empty())
+						argumentSeparators.push_back(CreateKeyword(SyntaxTokenType::Comma));
+
+					arguments.push_back(
+						SyntaxFactory::CreateLiteralExpression(
+							LiteralType::String,
+							CreateToken(SyntaxTokenType::StringLiteral, argument, " ")));
+				}
+
+				rows.push_back(
+					SyntaxFactory::CreateInitializerList(
+						CreateKeyword(SyntaxTokenType::OpenBrace, "\n\t\t"),
+						SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>(
+							std::move(arguments),
+							std::move(argumentSeparators)),
+						CreateKeyword(SyntaxTokenType::CloseBrace, theory.empty() ? "" : " ")));
+
+				// "[ARGUMENTS]",
+				auto rowName = std::string();
+				for (auto& argument : theory)
+				{
+					if (!rowName.empty())
+						rowName += ", ";
+
+					rowName += argument;
+				}
+
+				rowNames.push_back(
+					SyntaxFactory::CreateLiteralExpression(
+						LiteralType::String,
+						CreateToken(SyntaxTokenType::StringLiteral, "\"" + EscapeString(rowName) + "\"", "\n\t\t")));
+			}
+
+			// static const SoupTest::TheoryRow<&[CLASS_TYPE]::[TEST_NAME]> [TEST_NAME]Rows[] = { [ROWS] };
+			auto methodName = std::string(testMethod.Name);
+			statements.push_back(
+				BuildStaticTableDeclaration(
+					"static const",
+					SyntaxFactory::CreateSimpleTemplateIdentifier(
+						CreateToken(SyntaxTokenType::Identifier, "TheoryRow"),
+						CreateKeyword(SyntaxTokenType::LessThan),
+						SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>(
+							{
+								BuildMethodAddress(testClass, methodName),
+							},
+							{}),
+						CreateKeyword(SyntaxTokenType::GreaterThan)),
+					methodName + "Rows",
+					std::move(rows)));
+
+			// static constexpr SoupTest::TheoryRowName [TEST_NAME]RowNames[] = { [ROW_NAMES] };
+			statements.push_back(
+				BuildStaticTableDeclaration(
+					"static constexpr",
+					SyntaxFactory::CreateSimpleIdentifier(
+						CreateToken(SyntaxTokenType::Identifier, "TheoryRowName")),
+					methodName + "RowNames",
+					std::move(rowNames)));
+		}
+
+		template<typename TIdentifier>
+		static std::shared_ptr<const Statement> BuildStaticTableDeclaration(
+			const std::string& specifiers,
+			std::shared_ptr<const TIdentifier> typeIdentifier,
+			const std::string& variableName,
+			std::vector<std::shared_ptr<const SyntaxNode>> rows)
+		{
+			// Every row is followed by a comma
+			std::vector<std::shared_ptr<const SyntaxToken>> rowSeparators = {};
+			for (size_t i = 0; i < rows.size(); i++)
+			{
+				rowSeparators.push_back(CreateKeyword(SyntaxTokenType::Comma));
+			}
+
+			// [SPECIFIERS] SoupTest::[TYPE] [VARIABLE_NAME][] = { [ROWS] };
+			// Hack: The storage class specifiers and the array declarator are carried as trivia
+			return SyntaxFactory::CreateDeclarationStatement(
+				SyntaxFactory::CreateSimpleDeclaration(
+					SyntaxFactory::CreateDeclarationSpecifierSequence(
+						SyntaxFactory::CreateIdentifierType(
+							BuildSoupTestQualifier("\n\t" + specifiers + " "),
+							std::move(typeIdentifier))),
+					SyntaxFactory::CreateInitializerDeclaratorList(
+						SyntaxFactory::CreateSyntaxSeparatorList<InitializerDeclarator>(
+							{
+								SyntaxFactory::CreateInitializerDeclarator(
+									SyntaxFactory::CreateSimpleIdentifier(
+										CreateToken(SyntaxTokenType::Identifier, variableName, " ", "[]")),
+									SyntaxFactory::CreateValueEqualInitializer(
+										CreateKeyword(SyntaxTokenType::Equal, " "),
+										SyntaxFactory::CreateInitializerList(
+											CreateKeyword(SyntaxTokenType::OpenBrace, "\n\t"),
+											SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>(
+												std::move(rows),
+												std::move(rowSeparators)),
+											CreateKeyword(SyntaxTokenType::CloseBrace, "\n\t")))),
+							},
+							{})),
+					CreateKeyword(SyntaxTokenType::Semicolon)));
+		}
+
+		static std::shared_ptr<const SyntaxNode> BuildTestDescriptor(
+			const TestClass& testClass,
+			const TestMethod& testMethod)
+		{
+			auto methodName = std::string(testMethod.Name);
+			std::shared_ptr<const SyntaxNode> testCall;
+			std::shared_ptr<const SyntaxNode> rowNames;
+			std::string thunkParameters;
+			if (testMethod.IsTheory)
+			{
+				// SoupTest::InvokeTheory<&[CLASS_TYPE]::[TEST_NAME]>(testClass, [TEST_NAME]Rows[row]);
+				// Hack: The row subscript is carried as trivia
+				thunkParameters = "void* testClass, size_t row";
+				testCall = SyntaxFactory::CreateInvocationExpression(
+					SyntaxFactory::CreateIdentifierExpression(
+						BuildSoupTestQualifier(" "),
+						SyntaxFactory::CreateSimpleTemplateIdentifier(
+							CreateToken(SyntaxTokenType::Identifier, "InvokeTheory"),
+							CreateKeyword(SyntaxTokenType::LessThan),
+							SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>(
+								{
+									BuildMethodAddress(testClass, methodName),
+								},
+								{}),
+							CreateKeyword(SyntaxTokenType::GreaterThan))),
+					CreateKeyword(SyntaxTokenType::OpenParenthesis),
+					SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>(
+						{
+							SyntaxFactory::CreateIdentifierExpression(
+								SyntaxFactory::CreateSimpleIdentifier(
+									CreateToken(SyntaxTokenType::Identifier, "testClass"))),
+							SyntaxFactory::CreateIdentifierExpression(
+								SyntaxFactory::CreateSimpleIdentifier(
+									CreateToken(SyntaxTokenType::Identifier, methodName + "Rows", " ", "[row]"))),
+						},
+						{
+							CreateKeyword(SyntaxTokenType::Comma),
+						}),
+					CreateKeyword(SyntaxTokenType::CloseParenthesis));
+
+				// [TEST_NAME]RowNames
+				rowNames = SyntaxFactory::CreateIdentifierExpression(
+					SyntaxFactory::CreateSimpleIdentifier(
+						CreateToken(SyntaxTokenType::Identifier, methodName + "RowNames", " ")));
+			}
+			else if (testMethod.IsBenchmark)
+			{
+				// SoupTest::InvokeBenchmark<&[CLASS_TYPE]::[TEST_NAME]>(testClass, iterations);
+				thunkParameters = "void* testClass, size_t iterations";
+				testCall = SyntaxFactory::CreateInvocationExpression(
+					SyntaxFactory::CreateIdentifierExpression(
+						BuildSoupTestQualifier(" "),
+						SyntaxFactory::CreateSimpleTemplateIdentifier(
+							CreateToken(SyntaxTokenType::Identifier, "InvokeBenchmark"),
+							CreateKeyword(SyntaxTokenType::LessThan),
+							SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>(
+								{
+									BuildMethodAddress(testClass, methodName),
+								},
+								{}),
+							CreateKeyword(SyntaxTokenType::GreaterThan))),
+					CreateKeyword(SyntaxTokenType::OpenParenthesis),
+					SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>(
+						{
+							SyntaxFactory::CreateIdentifierExpression(
+								SyntaxFactory::CreateSimpleIdentifier(
+									CreateToken(SyntaxTokenType::Identifier, "testClass"))),
+							SyntaxFactory::CreateIdentifierExpression(
+								SyntaxFactory::CreateSimpleIdentifier(
+									CreateToken(SyntaxTokenType::Identifier, "iterations", " "))),
+						},
+						{
+							CreateKeyword(SyntaxTokenType::Comma),
+						}),
+					CreateKeyword(SyntaxTokenType::CloseParenthesis));
+
+				// {}
+				rowNames = SyntaxFactory::CreateInitializerList(
+					CreateKeyword(SyntaxTokenType::OpenBrace, " "),
+					SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>({}, {}),
+					CreateKeyword(SyntaxTokenType::CloseBrace));
+			}
+			else
+			{
+				// static_cast<[CLASS_TYPE]*>(testClass)->[TEST_NAME]();
+				thunkParameters = "void* testClass, size_t";
+				testCall = SyntaxFactory::CreateInvocationExpression(
+					SyntaxFactory::CreateBinaryExpression(
+						BinaryOperator::MemberOfPointer,
+						SyntaxFactory::CreateInvocationExpression(
+							SyntaxFactory::CreateIdentifierExpression(
+								SyntaxFactory::CreateSimpleTemplateIdentifier(
+									CreateToken(SyntaxTokenType::Identifier, "static_cast", " "),
+									CreateKeyword(SyntaxTokenType::LessThan),
+									SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>(
+										{
+											BuildClassType(testClass, "*"),
+										},
+										{}),
+									CreateKeyword(SyntaxTokenType::GreaterThan))),
+							CreateKeyword(SyntaxTokenType::OpenParenthesis),
+							SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>(
+								{
+									SyntaxFactory::CreateIdentifierExpression(
+										SyntaxFactory::CreateSimpleIdentifier(
+											CreateToken(SyntaxTokenType::Identifier, "testClass"))),
+								},
+								{}),
+							CreateKeyword(SyntaxTokenType::CloseParenthesis)),
+						CreateKeyword(SyntaxTokenType::Arrow),
+						SyntaxFactory::CreateIdentifierExpression(
+							SyntaxFactory::CreateSimpleIdentifier(
+								CreateToken(SyntaxTokenType::Identifier, methodName)))),
+					CreateKeyword(SyntaxTokenType::OpenParenthesis),
+					SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>({}, {}),
+					CreateKeyword(SyntaxTokenType::CloseParenthesis));
+
+				// {}
+				rowNames = SyntaxFactory::CreateInitializerList(
+					CreateKeyword(SyntaxTokenType::OpenBrace, " "),
+					SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>({}, {}),
+					CreateKeyword(SyntaxTokenType::CloseBrace));
+			}
+
+			// [](void* testClass, size_t row) { [TEST_CALL]; }
+			// Hack: The thunk parameters are carried as trivia
+			auto testThunk = SyntaxFactory::CreateLambdaExpression(
+				CreateKeyword(SyntaxTokenType::OpenBracket, " "),
+				SyntaxFactory::CreateSyntaxSeparatorList<LambdaCaptureClause>({}, {}),
+				CreateKeyword(SyntaxTokenType::CloseBracket),
+				SyntaxFactory::CreateParameterList(
+					CreateKeyword(SyntaxTokenType::OpenParenthesis, "", thunkParameters),
+					SyntaxFactory::CreateSyntaxSeparatorList<Parameter>({}, {}),
+					CreateKeyword(SyntaxTokenType::CloseParenthesis)),
+				SyntaxFactory::CreateCompoundStatement(
+					CreateKeyword(SyntaxTokenType::OpenBrace, " "),
+					SyntaxFactory::CreateSyntaxList<Statement>({
+						SyntaxFactory::CreateExpressionStatement(
+							testCall,
+							CreateKeyword(SyntaxTokenType::Semicolon)),
+					}),
+					CreateKeyword(SyntaxTokenType::CloseBrace, " ")));
+
+			// { "[TEST_NAME]", 0, [TEST_THUNK], [ROW_NAMES][, IS_BENCHMARK[, TIMEOUT]] }
+			std::vector<std::shared_ptr<const SyntaxNode>> fields =
+			{
+				SyntaxFactory::CreateLiteralExpression(
+					LiteralType::String,
+					CreateToken(SyntaxTokenType::StringLiteral, "\"" + methodName + "\"", " ")),
+				SyntaxFactory::CreateLiteralExpression(
+					LiteralType::Integer,
+					CreateToken(SyntaxTokenType::IntegerLiteral, "0", " ")),
+				testThunk,
+				rowNames,
+			};
+			std::vector<std::shared_ptr<const SyntaxToken>> fieldSeparators =
+			{
+				CreateKeyword(SyntaxTokenType::Comma),
+				CreateKeyword(SyntaxTokenType::Comma),
+				CreateKeyword(SyntaxTokenType::Comma),
+			};
+
+			// The trailing fields are only written when they differ from their defaults so most tests keep the shorter rows
+			// Hack: The flag is carried as a literal token like the theory arguments
+			if (testMethod.IsBenchmark || testMethod.TimeoutMilliseconds > 0)
+			{
+				fields.push_back(
+					SyntaxFactory::CreateLiteralExpression(
+						LiteralType::String,
+						CreateToken(SyntaxTokenType::StringLiteral, testMethod.IsBenchmark ? "true" : "false", " ")));
+				fieldSeparators.push_back(CreateKeyword(SyntaxTokenType::Comma));
+			}
+
+			if (testMethod.TimeoutMilliseconds > 0)
+			{
+				fields.push_back(
+					SyntaxFactory::CreateLiteralExpression(
+						LiteralType::Integer,
+						CreateToken(SyntaxTokenType::IntegerLiteral, std::to_string(testMethod.TimeoutMilliseconds), " ")));
+				fieldSeparators.push_back(CreateKeyword(SyntaxTokenType::Comma));
+			}
+
+			return SyntaxFactory::CreateInitializerList(
+				CreateKeyword(SyntaxTokenType::OpenBrace, "\n\t\t"),
+				SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>(
+					std::move(fields),
+					std::move(fieldSeparators)),
+				CreateKeyword(SyntaxTokenType::CloseBrace, " "));
+		}
+
+		static std::shared_ptr<const SyntaxNode> BuildMethodAddress(
+			const TestClass& testClass,
+			const std::string& methodName)
+		{
+			// &[CLASS_TYPE]::[TEST_NAME]
+			// Hack: The address of operator is carried as trivia
+			std::vector<std::shared_ptr<const SyntaxNode>> classIdentifiers = {};
+			std::vector<std::shared_ptr<const SyntaxToken>> classSeparators = {};
+			auto leadingTrivia = std::string("&");
+			for (auto& qualifier : testClass.GetQualifiers())
+			{
+				classIdentifiers.push_back(
+					SyntaxFactory::CreateSimpleIdentifier(
+						CreateToken(SyntaxTokenType::Identifier, std::string(qualifier), std::exchange(leadingTrivia, std::string()))));
+				classSeparators.push_back(CreateKeyword(SyntaxTokenType::DoubleColon));
+			}
+
+			classIdentifiers.push_back(
+				SyntaxFactory::CreateSimpleIdentifier(
+					CreateToken(SyntaxTokenType::Identifier, std::string(testClass.GetName()), std::move(leadingTrivia))));
+			classSeparators.push_back(CreateKeyword(SyntaxTokenType::DoubleColon));
+
+			return SyntaxFactory::CreateIdentifierExpression(
+				SyntaxFactory::CreateNestedNameSpecifier(
+					SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>(
+						std::move(classIdentifiers),
+						std::move(classSeparators))),
+				SyntaxFactory::CreateSimpleIdentifier(
+					CreateToken(SyntaxTokenType::Identifier, methodName)));
+		}
+
+		static std::shared_ptr<const SyntaxNode> BuildClassType(
+			const TestClass& testClass,
+			std::string trailingTrivia = "")
+		{
+			// Build up the class type with qualifier
+			std::vector<std::shared_ptr<const SyntaxNode>> namespaceIdentifiers = {};
+			std::vector<std::shared_ptr<const SyntaxToken>> namespaceSeparators = {};
+
+			for (auto& qualifier : testClass.GetQualifiers())
+			{
+				namespaceIdentifiers.push_back(
+					SyntaxFactory::CreateSimpleIdentifier(
+						SyntaxFactory::CreateUniqueToken(SyntaxTokenType::Identifier, std::string(qualifier))));
+				namespaceSeparators.push_back(
+					SyntaxFactory::CreateKeywordToken(SyntaxTokenType::DoubleColon));
+			}
+
+			return SyntaxFactory::CreateTypeSpecifierSequence(
+				SyntaxFactory::CreateIdentifierType(
+					SyntaxFactory::CreateNestedNameSpecifier(
+						SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>(
+							std::move(namespaceIdentifiers),
+							std::move(namespaceSeparators))),
+					SyntaxFactory::CreateSimpleIdentifier(
+						CreateToken(
+							SyntaxTokenType::Identifier,
+							std::string(testClass.GetName()),
+							"",
+							std::move(trailingTrivia)))));
+		}
+
+		static std::shared_ptr<const NestedNameSpecifier> BuildSoupTestQualifier(
+			std::string leadingTrivia)
+		{
+			// SoupTest::
+			return SyntaxFactory::CreateNestedNameSpecifier(
+				SyntaxFactory::CreateSyntaxSeparatorList<SyntaxNode>(
+					{
+						SyntaxFactory::CreateSimpleIdentifier(
+							CreateToken(SyntaxTokenType::Identifier, "SoupTest", std::move(leadingTrivia))),
+					},
+					{
+						CreateKeyword(SyntaxTokenType::DoubleColon),
+					}));
+		}
+
+		static std::shared_ptr<const SyntaxToken> CreateKeyword(
+			SyntaxTokenType type,
+			std::string leadingTrivia = "",
+			std::string trailingTrivia = "")
+		{
+			if (leadingTrivia.empty() && trailingTrivia.empty())
+			{
+				return SyntaxFactory::CreateKeywordToken(type);
+			}
+			else if (trailingTrivia.empty())
+			{
+				return SyntaxFactory::CreateKeywordToken(
+					type,
+					{
+						SyntaxFactory::CreateTrivia(std::move(leadingTrivia)),
+					},
+					{});
+			}
+			else if (leadingTrivia.empty())
+			{
+				return SyntaxFactory::CreateKeywordToken(
+					type,
+					{},
+					{
+						SyntaxFactory::CreateTrivia(std::move(trailingTrivia)),
+					});
+			}
+			else
+			{
+				return SyntaxFactory::CreateKeywordToken(
+					type,
+					{
+						SyntaxFactory::CreateTrivia(std::move(leadingTrivia)),
+					},
+					{
+						SyntaxFactory::CreateTrivia(std::move(trailingTrivia)),
+					});
+			}
+		}
+
+		static std::shared_ptr<const SyntaxToken> CreateToken(
+			SyntaxTokenType type,
+			std::string value,
+			std::string leadingTrivia = "",
+			std::string trailingTrivia = "")
+		{
+			if (leadingTrivia.empty() && trailingTrivia.empty())
+			{
+				return SyntaxFactory::CreateUniqueToken(type, std::move(value));
+			}
+			else if (trailingTrivia.empty())
+			{
+				return SyntaxFactory::CreateUniqueToken(
+					type,
+					std::move(value),
+					{
+						SyntaxFactory::CreateTrivia(std::move(leadingTrivia)),
+					},
+					{});
+			}
+			else if (leadingTrivia.empty())
+			{
+				return SyntaxFactory::CreateUniqueToken(
+					type,
+					std::move(value),
+					{},
+					{
+						SyntaxFactory::CreateTrivia(std::move(trailingTrivia)),
+					});
+			}
+			else
+			{
+				return SyntaxFactory::CreateUniqueToken(
+					type,
+					std::move(value),
+					{
+						SyntaxFactory::CreateTrivia(std::move(leadingTrivia)),
+					},
+					{
+						SyntaxFactory::CreateTrivia(std::move(trailingTrivia)),
+					});
+			}
+		}
+
+		static std::string EscapeString(const std::string& value)
+		{
+			// The value is raw source text so every quote and backslash must be escaped
+			auto result = std::string();
+			for (char character : value)
+			{
+				if (character == '\"' || character == '\\')
+				{
+					result += '\\';
+				}
+
+				result += character;
+			}
+
+			return result;
+		}
+	};
+}
@@ -0,0 +1,244 @@
+﻿// <copyright file="test-runner-writer.h" company="Soup">
+// Copyright (c) Soup. All rights reserved.
+// </copyright>
+
+#pragma once
+
+namespace Soup::Test
+{
+	/// <summary>
+	/// The direct test runner emitter that writes the runner text straight into an output buffer.
+	/// The text must stay byte for byte identical to the TestRunnerSyntaxBuilder reference output.
+	/// </summary>
+	class TestRunnerWriter
+	{
+	public:
+		static void WriteTestRunner(
+			const TestBuilder& testBuilder,
+			const std::string& file,
+			std::string_view moduleName,
+			std::string& output)
+		{
+			auto isModule = !moduleName.empty();
+			if (isModule)
+			{
+				// export module [TEST_MODULE].TestRunner;
+				// import Soup.Test.Assert;
+				// import [TEST_MODULE];
+				output += "export module ";
+				output += moduleName;
+				output += ".TestRunner;\nimport Soup.Test.Assert;\nimport ";
+				output += moduleName;
+				output += ";\n\nnamespace SoupTest = Soup::Test;\nusing Soup::Test::TestState;\n";
+			}
+			else
+			{
+				// #pragma once
+				// #include "[TEST_FILE]"
+				output += "#pragma once\n#include \"";
+				output += file;
+				output += "\"\n";
+			}
+
+			for (auto& testClass : testBuilder.GetTestClasses())
+			{
+				WriteTestTableFunction(testClass, isModule, output);
+				WriteTestRunnerFunction(testClass, isModule, output);
+			}
+		}
+
+	private:
+		static void WriteTestTableFunction(
+			const TestClass& testClass,
+			bool isExported,
+			std::string& output)
+		{
+			// [export] SoupTest::TestTable Get[TEST_CLASS]Tests()
+			output += isExported ? "\nexport SoupTest::TestTable Get" : "\nSoupTest::TestTable Get";
+			output += testClass.GetName();
+			output += "Tests()\n{";
+
+			// static constexpr SoupTest::TestClassDescriptor testClasses[] = { { "[CLASS_TYPE]", ..., SoupTest::TestClassExecution<[CLASS_TYPE]>, SoupTest::TestClassCollectionFixtures<[CLASS_TYPE]> }, };
+			output += "\n\tstatic constexpr SoupTest::TestClassDescriptor testClasses[] =\n\t{";
+			output += "\n\t\t{ \"";
+			WriteClassType(testClass, output);
+			output += "\", SoupTest::CreateTestClass<";
+			WriteClassType(testClass, output);
+			output += ">, SoupTest::DestroyTestClass<";
+			WriteClassType(testClass, output);
+			output += ">, SoupTest::TestClassExecution<";
+			WriteClassType(testClass, output);
+			output += ">, SoupTest::TestClassCollectionFixtures<";
+			WriteClassType(testClass, output);
+			output += "> },\n\t};";
+
+			for (auto& testMethod : testClass.GetTestMethods())
+			{
+				if (testMethod.IsTheory)
+				{
+					WriteTheoryRows(testClass, testMethod, output);
+				}
+			}
+
+			// static constexpr SoupTest::TestDescriptor tests[] = { { "[TEST_NAME]", 0, [THUNK], [ROW_NAMES][, IS_BENCHMARK[, TIMEOUT]] }, };
+			output += "\n\tstatic constexpr SoupTest::TestDescriptor tests[] =\n\t{";
+			for (auto& testMethod : testClass.GetTestMethods())
+			{
+				WriteTestDescriptor(testClass, testMethod, output);
+			}
+
+			output += "\n\t};";
+
+			// return { testClasses, tests };
+			output += "\n\n\treturn { testClasses, tests };\n}";
+		}
+
+		static void WriteTestRunnerFunction(
+			const TestClass& testClass,
+			bool isExported,
+			std::string& output)
+		{
+			// [export] TestState Run[TEST_CLASS]()
+			// {
+			//	return SoupTest::RunTests(Get[TEST_CLASS]Tests());
+			// }
+			output += isExported ? "\n\nexport TestState Run" : "\n\nTestState Run";
+			output += testClass.GetName();
+			output += "()\n{\n\treturn SoupTest::RunTests(Get";
+			output += testClass.GetName();
+			output += "Tests());\n}\n";
+		}
+
+		static void WriteTheoryRows(
+			const TestClass& testClass,
+			const TestMethod& testMethod,
+			std::string& output)
+		{
+			// static const SoupTest::TheoryRow<&[CLASS_TYPE]::[TEST_NAME]> [TEST_NAME]Rows[] = { { [ARGUMENTS] }, };
+			output += "\n\tstatic const SoupTest::TheoryRow<&";
+			WriteClassType(testClass, output);
+			output += "::";
+			output += testMethod.Name;
+			output += "> ";
+			output += testMethod.Name;
+			output += "Rows[] =\n\t{";
+			for (auto& theory : testMethod.Theories)
+			{
+				output += "\n\t\t{";
+				if (!theory.empty())
+				{
+					output += " ";
+					WriteArguments(theory, output);
+					output += " ";
+				}
+
+				output += "},";
+			}
+
+			output += "\n\t};";
+
+			// static constexpr SoupTest::TheoryRowName [TEST_NAME]RowNames[] = { "[ARGUMENTS]", };
+			output += "\n\tstatic constexpr SoupTest::TheoryRowName ";
+			output += testMethod.Name;
+			output += "RowNames[] =\n\t{";
+			for (auto& theory : testMethod.Theories)
+			{
+				auto rowName = std::string();
+				WriteArguments(theory, rowName);
+				output += "\n\t\t\"";
+				AppendEscapedString(rowName, output);
+				output += "\",";
+			}
+
+			output += "\n\t};";
+		}
+
+		static void WriteTestDescriptor(
+			const TestClass& testClass,
+			const TestMethod& testMethod,
+			std::string& output)
+		{
+			output += "\n\t\t{ \"";
+			output += testMethod.Name;
+			if (testMethod.IsTheory)
+			{
+				// { "[TEST_NAME]", 0, [](void* testClass, size_t row) { SoupTest::InvokeTheory<&[CLASS_TYPE]::[TEST_NAME]>(testClass, [TEST_NAME]Rows[row]); }, [TEST_NAME]RowNames },
+				output += "\", 0, [](void* testClass, size_t row) { SoupTest::InvokeTheory<&";
+				WriteClassType(testClass, output);
+				output += "::";
+				output += testMethod.Name;
+				output += ">(testClass, ";
+				output += testMethod.Name;
+				output += "Rows[row]); }, ";
+				output += testMethod.Name;
+				output += "RowNames";
+			}
+			else if (testMethod.IsBenchmark)
+			{
+				// { "[TEST_NAME]", 0, [](void* testClass, size_t iterations) { SoupTest::InvokeBenchmark<&[CLASS_TYPE]::[TEST_NAME]>(testClass, iterations); }, {}
+				output += "\", 0, [](void* testClass, size_t iterations) { SoupTest::InvokeBenchmark<&";
+				WriteClassType(testClass, output);
+				output += "::";
+				output += testMethod.Name;
+				output += ">(testClass, iterations); }, {}";
+			}
+			else
+			{
+				// { "[TEST_NAME]", 0, [](void* testClass, size_t) { static_cast<[CLASS_TYPE]*>(testClass)->[TEST_NAME](); }, {}
+				output += "\", 0, [](void* testClass, size_t) { static_cast<";
+				WriteClassType(testClass, output);
+				output += "*>(testClass)->";
+				output += testMethod.Name;
+				output += "(); }, {}";
+			}
+
+			// The trailing fields are only written when they differ from their defaults
+			// [, true|false[, [TIMEOUT]]] },
+			if (testMethod.IsBenchmark || testMethod.TimeoutMilliseconds > 0)
+				output += testMethod.IsBenchmark ? ", true" : ", false";
+			if (testMethod.TimeoutMilliseconds > 0)
+			{
+				output += ", ";
+				output += std::to_string(testMethod.TimeoutMilliseconds);
+			}
+
+			output += " },";
+		}
+
+		static void WriteArguments(const TheoryArguments& arguments, std::string& output)
+		{
+			for (size_t i = 0; i < arguments.size(); i++)
+			{
+				if (i > 0)
+					output += ", ";
+
+				output += arguments[i];
+			}
+		}
+
+		static void WriteClassType(const TestClass& testClass, std::string& output)
+		{
+			for (auto& qualifier : testClass.GetQualifiers())
+			{
+				output += qualifier;
+				output += "::";
+			}
+
+			output += testClass.GetName();
+		}
+
+		static void AppendEscapedString(std::string_view value, std::string& output)
+		{
+			// The value is raw source text so every quote and backslash must be escaped
+			for (char character : value)
+			{
+				if (character == '\"' || character == '\\')
+				{
+					output += '\\';
+				}
+
+				output += character;
+			}
+		}
+	};
+}
@@ -0,0 +1,213 @@
+﻿// <copyright file="test-shard-writer.h" company="Soup">
+// Copyright (c) Soup. All rights reserved.
+// </copyright>
+
+#pragma once
+
+namespace Soup::Test
+{
+	/// <summary>
+	/// A generated runner and the test classes it registers, a module runner is imported by name instead of included
+	/// </summary>
+	struct ShardRunner
+	{
+		std::string IncludeFile;
+		std::string ModuleName;
+		std::vector<std::string> TestClasses;
+		uint64_t Weight;
+	};
+
+	/// <summary>
+	/// Splits the generated runners across a fixed number of translation units so the harness
+	/// compiles on every core, and writes the registry unit that holds the harness entry point
+	/// </summary>
+	class TestShardWriter
+	{
+	public:
+		static constexpr std::string_view RegistryFileName = "test-registry.cpp";
+
+		/// <summary>
+		/// The compile cost of a runner header on its own, so a file with few tests still carries weight
+		/// </summary>
+		static constexpr uint64_t FileWeight = 4;
+
+		static std::string GetShardFileName(size_t shard)
+		{
+			return "test-shard-" + std::to_string(shard) + ".cpp";
+		}
+
+		/// <summary>
+		/// Assign each runner to a shard with bounded load rendezvous hashing.
+		/// Every runner ranks the shards by a hash of its own path and takes the first one with room left,
+		/// so adding, removing or resizing one runner only moves the few runners that competed with it.
+		/// </summary>
+		static std::vector<std::vector<const ShardRunner*>> AssignShards(
+			const std::vector<ShardRunner>& runners,
+			size_t shardCount)
+		{
+			uint64_t totalWeight = 0;
+			for (auto& runner : runners)
+				totalWeight += runner.Weight;
+
+			// Allow each shard an eighth over the even split before spilling over to the next choice
+			auto capacity = (totalWeight + totalWeight / 8 + shardCount - 1) / shardCount;
+
+			// Place in path hash order, which does not depend on the other runners or their weights
+			auto order = std::vector<std::pair<uint64_t, const ShardRunner*>>();
+			order.reserve(runners.size());
+			for (auto& runner : runners)
+				order.emplace_back(GenerationCache::HashContent(runner.IncludeFile), &runner);
+			std::sort(
+				order.begin(),
+				order.end(),
+				[](const auto& lhs, const auto& rhs)
+				{
+					return lhs.first != rhs.first ? lhs.first < rhs.first : lhs.second->IncludeFile < rhs.second->IncludeFile;
+				});
+
+			auto shards = std::vector<std::vector<const ShardRunner*>>(shardCount);
+			auto loads = std::vector<uint64_t>(shardCount, 0);
+			auto ranking = std::vector<std::pair<uint64_t, size_t>>(shardCount);
+			for (auto& [pathHash, runner] : order)
+			{
+				for (size_t shard = 0; shard < shardCount; shard++)
+					ranking[shard] = { Mix(pathHash ^ Mix(shard + 1)), shard };
+				std::sort(ranking.begin(), ranking.end(), std::greater<>());
+
+				// A runner larger than any shard allowance goes to the least loaded shard
+				auto selected = ranking.front().second;
+				auto isPlaced = false;
+				for (auto& [score, shard] : ranking)
+				{
+					if (loads[shard] + runner->Weight <= capacity)
+					{
+						selected = shard;
+						isPlaced = true;
+						break;
+					}
+				}
+
+				if (!isPlaced)
+				{
+					for (auto& [score, shard] : ranking)
+					{
+						if (loads[shard] < loads[selected])
+							selected = shard;
+					}
+				}
+
+				loads[selected] += runner->Weight;
+				shards[selected].push_back(runner);
+			}
+
+			// Keep the includes in path order so the unit text does not depend on the hash order
+			for (auto& shard : shards)
+			{
+				std::sort(
+					shard.begin(),
+					shard.end(),
+					[](const ShardRunner* lhs, const ShardRunner* rhs) { return lhs->IncludeFile < rhs->IncludeFile; });
+			}
+
+			return shards;
+		}
+
+		static void WriteShard(
+			size_t shard,
+			size_t shardCount,
+			const std::vector<const ShardRunner*>& runners,
+			std::string& output)
+		{
+			output += "// Generated test runner shard ";
+			output += std::to_string(shard);
+			output += " of ";
+			output += std::to_string(shardCount);
+			output += "\n";
+
+			// A runner header only includes its test header, the shard provides the same prelude as a runner module unit
+			output += "import Soup.Test.Assert;\n\nnamespace SoupTest = Soup::Test;\nusing Soup::Test::TestState;\n\n";
+
+			// #include "[RUNNER_FILE]"
+			// import [TEST_MODULE].TestRunner;
+			for (auto& runner : runners)
+			{
+				if (runner->ModuleName.empty())
+				{
+					output += "#include \"";
+					output += runner->IncludeFile;
+					output += "\"\n";
+				}
+				else
+				{
+					output += "import ";
+					output += runner->ModuleName;
+					output += ".TestRunner;\n";
+				}
+			}
+
+			// void AddTestShard[SHARD](Soup::Test::TestScheduler& scheduler)
+			output += "\nvoid AddTestShard";
+			output += std::to_string(shard);
+			output += "(Soup::Test::TestScheduler& scheduler)\n{";
+			for (auto& runner : runners)
+			{
+				for (auto& testClass : runner->TestClasses)
+				{
+					// scheduler.Add(Get[TEST_CLASS]Tests());
+					output += "\n\tscheduler.Add(Get";
+					output += GetClassName(testClass);
+					output += "Tests());";
+				}
+			}
+
+			output += "\n}\n";
+		}
+
+		static void WriteRegistry(size_t shardCount, std::string& output)
+		{
+			output += "// Generated test registry for ";
+			output += std::to_string(shardCount);
+			output += " runner shards\nimport Soup.Test.Assert;\n\n";
+
+			// void AddTestShard[SHARD](Soup::Test::TestScheduler& scheduler);
+			for (size_t shard = 0; shard < shardCount; shard++)
+			{
+				output += "void AddTestShard";
+				output += std::to_string(shard);
+				output += "(Soup::Test::TestScheduler& scheduler);\n";
+			}
+
+			// void AddAllTests(Soup::Test::TestScheduler& scheduler)
+			output += "\nvoid AddAllTests(Soup::Test::TestScheduler& scheduler)\n{";
+			for (size_t shard = 0; shard < shardCount; shard++)
+			{
+				output += "\n\tAddTestShard";
+				output += std::to_string(shard);
+				output += "(scheduler);";
+			}
+
+			// int main(int argc, char** argv)
+			output += "\n}\n\nint main(int argc, char** argv)\n{\n\treturn Soup::Test::TestHarness::Run(argc, argv, AddAllTests);\n}\n";
+		}
+
+	private:
+		static std::string_view GetClassName(std::string_view qualifiedName)
+		{
+			auto separator = qualifiedName.rfind("::");
+			return separator == std::string_view::npos ? qualifiedName : qualifiedName.substr(separator + 2);
+		}
+
+		/// <summary>
+		/// The splitmix64 finalizer, spreads the shard index across the whole word before it is combined
+		/// </summary>
+		static uint64_t Mix(uint64_t value)
+		{
+			value ^= value >> 30;
+			value *= 0xbf58476d1ce4e5b9ull;
+			value ^= value >> 27;
+			value *= 0x94d049bb133111ebull;
+			value ^= value >> 31;
+			return value;
+		}
+	};
+}
@@ -0,0 +1,197 @@
+﻿// <copyright file="emitter-tests.cpp" company="Soup">
+// Copyright (c) Soup. All rights reserved.
+// </copyright>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <streambuf>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#endif
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+import SoupSyntaxParser;
+
+#include "../program.h"
+#include "../benchmark/synthetic-corpus.h"
+
+namespace Soup::Test::UnitTests
+{
+	/// <summary>
+	/// Generates a fixed corpus that covers facts, theories, nested namespaces, helpers and module units
+	/// once with each emitter, the runners must match byte for byte
+	/// </summary>
+	class EmitterTests
+	{
+	public:
+		EmitterTests() :
+			m_corpus(),
+			m_corpusDirectory(std::filesystem::temp_directory_path() / "soup-test-generator-tests" / "emitter-corpus"),
+			m_testCount(0)
+		{
+			m_corpus.FileCount = 32;
+			m_corpus.HelperFileCount = 4;
+			m_corpus.ModuleFileCount = 8;
+			m_corpus.ClassCount = 3;
+			m_corpus.FactCount = 3;
+			m_corpus.TheoryCount = 2;
+			m_corpus.InlineDataCount = 3;
+			m_corpus.NamespaceDepth = 3;
+			m_testCount = Benchmark::SyntheticCorpus::Create(m_corpusDirectory, m_corpus);
+		}
+
+		void TextEmitterMatchesSyntaxEmitter()
+		{
+			auto textRunners = Generate(RunnerEmitter::Text);
+			auto syntaxRunners = Generate(RunnerEmitter::Syntax);
+
+			if (textRunners.size() != syntaxRunners.size())
+			{
+				throw std::runtime_error(
+					"Text emitter wrote " + std::to_string(textRunners.size()) + " files, the syntax emitter wrote " +
+					std::to_string(syntaxRunners.size()) + ".");
+			}
+
+			for (auto& [file, textContent] : textRunners)
+			{
+				auto syntaxRunner = syntaxRunners.find(file);
+				if (syntaxRunner == syntaxRunners.end())
+					throw std::runtime_error("Syntax emitter did not write: " + file.string());
+
+				auto& syntaxContent = syntaxRunner->second;
+				auto mismatch = std::mismatch(
+					textContent.begin(), textContent.end(), syntaxContent.begin(), syntaxContent.end());
+				if (mismatch.first != textContent.end() || mismatch.second != syntaxContent.end())
+				{
+					auto offset = static_cast<size_t>(mismatch.first - textContent.begin());
+					auto contextStart = offset - std::min<size_t>(offset, 40);
+					throw std::runtime_error(
+						"Emitters differ at offset " + std::to_string(offset) + " of " + file.string() + "\n" +
+						"Text:   " + textContent.substr(contextStart, 80) + "\n" +
+						"Syntax: " + syntaxContent.substr(contextStart, 80));
+				}
+			}
+		}
+
+		void RunnersQualifyClassesFromEveryNamespaceBlock()
+		{
+			auto runners = Generate(RunnerEmitter::Text);
+
+			auto namespaceName = std::string("Benchmark");
+			for (size_t level = 0; level < m_corpus.NamespaceDepth; level++)
+				namespaceName += "::Level" + std::to_string(level);
+
+			// The first three files hold a single qualified block, one nested block per name and a mix of both
+			for (size_t fileIndex = 0; fileIndex < 3; fileIndex++)
+			{
+				auto file = std::filesystem::path("folder-0") / ("test-file-" + std::to_string(fileIndex) + ".gen.h");
+				auto runner = runners.find(file);
+				if (runner == runners.end())
+					throw std::runtime_error("Missing runner: " + file.string());
+
+				auto classType = namespaceName + "::File" + std::to_string(fileIndex) + "Class0Tests";
+				if (runner->second.find("SoupTest::CreateTestClass<" + classType + ">") == std::string::npos)
+					throw std::runtime_error("Runner " + file.string() + " does not qualify the class as " + classType);
+			}
+		}
+
+	private:
+		/// <summary>
+		/// Generate the corpus into a clean output folder and read back every runner, keyed by its path in the gen folder
+		/// </summary>
+		std::map<std::filesystem::path, std::string> Generate(RunnerEmitter emitter)
+		{
+			auto genDirectory = m_corpusDirectory / "gen";
+			std::filesystem::remove_all(genDirectory);
+
+			auto options = GeneratorOptions();
+			options.Directories = { m_corpusDirectory };
+			options.Emitter = emitter;
+			options.Verify = VerifyLevel::Full;
+			options.Verbosity = LogVerbosity::Quiet;
+			auto statistics = Program::Generate(options);
+
+			// A file rejected before the emitter runs would pass without being compared
+			auto testFileCount = m_corpus.FileCount + m_corpus.ModuleFileCount;
+			if (statistics.GeneratedCount != testFileCount || statistics.TestCount != m_testCount)
+			{
+				throw std::runtime_error(
+					"Generated " + std::to_string(statistics.GeneratedCount) + " of " +
+					std::to_string(testFileCount) + " files and " + std::to_string(statistics.TestCount) + " of " +
+					std::to_string(m_testCount) + " tests.");
+			}
+
+			// The manifest records the emitter, everything else must be identical
+			auto result = std::map<std::filesystem::path, std::string>();
+			for (auto& entry : std::filesystem::recursive_directory_iterator(genDirectory))
+			{
+				if (!entry.is_regular_file() || entry.path().filename() == GenerationCache::FileName)
+					continue;
+
+				auto file = std::ifstream(entry.path(), std::ios::binary);
+				auto content = std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+				result.emplace(entry.path().lexically_relative(genDirectory), std::move(content));
+			}
+
+			return result;
+		}
+
+	private:
+		Benchmark::SyntheticCorpusOptions m_corpus;
+		std::filesystem::path m_corpusDirectory;
+		size_t m_testCount;
+	};
+}
+
+int main()
+{
+	try
+	{
+		auto test = ::Soup::Test::UnitTests::EmitterTests();
+		test.TextEmitterMatchesSyntaxEmitter();
+		test.RunnersQualifyClassesFromEveryNamespaceBlock();
+		std::cout << "All Pass!" << std::endl;
+		return 0;
+	}
+	catch (const std::exception& ex)
+	{
+		std::cout << "FAIL: " << ex.what() << std::endl;
+		return -1;
+	}
+}
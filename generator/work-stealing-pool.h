@@ -0,0 +1,117 @@
+﻿// <copyright file="work-stealing-pool.h" company="Soup">
+// Copyright (c) Soup. All rights reserved.
+// </copyright>
+
+#pragma once
+
+namespace Soup::Test
+{
+	/// <summary>
+	/// A fixed size pool of workers that execute a known set of indexed tasks.
+	/// Each worker owns a deque seeded with a contiguous range of the tasks and pops work
+	/// from its own back, stealing from the front of the other workers when it runs dry.
+	/// </summary>
+	class WorkStealingPool
+	{
+	public:
+		WorkStealingPool(size_t workerCount) :
+			m_workerCount(std::max<size_t>(workerCount, 1))
+		{
+		}
+
+		size_t GetWorkerCount() const
+		{
+			return m_workerCount;
+		}
+
+		/// <summary>
+		/// Execute the task for every index in [0, taskCount) and block until all complete.
+		/// The calling thread participates as the first worker.
+		/// </summary>
+		void Run(size_t taskCount, const std::function<void(size_t)>& task)
+		{
+			auto workerCount = std::min(m_workerCount, std::max<size_t>(taskCount, 1));
+			if (workerCount == 1)
+			{
+				for (size_t i = 0; i < taskCount; i++)
+					task(i);
+				return;
+			}
+
+			// Seed each worker with a contiguous slice of the work
+			auto queues = std::vector<WorkQueue>(workerCount);
+			for (size_t worker = 0; worker < workerCount; worker++)
+			{
+				auto begin = taskCount * worker / workerCount;
+				auto end = taskCount * (worker + 1) / workerCount;
+				for (auto i = begin; i < end; i++)
+					queues[worker].Tasks.push_back(i);
+			}
+
+			auto threads = std::vector<std::thread>();
+			threads.reserve(workerCount - 1);
+			for (size_t worker = 1; worker < workerCount; worker++)
+			{
+				threads.emplace_back([&queues, &task, worker]()
+				{
+					RunWorker(queues, worker, task);
+				});
+			}
+
+			RunWorker(queues, 0, task);
+
+			for (auto& thread : threads)
+				thread.join();
+		}
+
+	private:
+		struct WorkQueue
+		{
+			std::mutex Mutex;
+			std::deque<size_t> Tasks;
+		};
+
+		static void RunWorker(
+			std::vector<WorkQueue>& queues,
+			size_t worker,
+			const std::function<void(size_t)>& task)
+		{
+			size_t index = 0;
+			while (TryPop(queues[worker], index) || TrySteal(queues, worker, index))
+			{
+				task(index);
+			}
+		}
+
+		static bool TryPop(WorkQueue& queue, size_t& index)
+		{
+			auto lock = std::lock_guard<std::mutex>(queue.Mutex);
+			if (queue.Tasks.empty())
+				return false;
+
+			index = queue.Tasks.back();
+			queue.Tasks.pop_back();
+			return true;
+		}
+
+		static bool TrySteal(std::vector<WorkQueue>& queues, size_t thief, size_t& index)
+		{
+			// The task list is fixed up front, so a full pass over empty victims means all work is claimed
+			for (size_t offset = 1; offset < queues.size(); offset++)
+			{
+				auto& victim = queues[(thief + offset) % queues.size()];
+				auto lock = std::lock_guard<std::mutex>(victim.Mutex);
+				if (!victim.Tasks.empty())
+				{
+					index = victim.Tasks.front();
+					victim.Tasks.pop_front();
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		size_t m_workerCount;
+	};
+}